@@ -0,0 +1,154 @@
+#include <AsyncLog.h>
+#include <stdarg.h>
+
+AsyncLog asyncLog;
+
+AsyncLog::AsyncLog()
+    : enqueue_pos(0), dequeue_pos(0), task(NULL), written(0), dropped(0), suppressed(0)
+{
+    for (uint16_t i = 0; i < SLOTS; i++)
+    {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+        slots[i].length = 0;
+    }
+}
+
+bool AsyncLog::begin()
+{
+    if (!task)
+    {
+        // Lowest priority on Core 0: Serial may block here, nowhere else
+        xTaskCreatePinnedToCore(
+            drainTask,
+            "LogTask",
+            STACK_SIZE,
+            this,
+            0,
+            &task,
+            0 // Core 0
+        );
+    }
+    return task != NULL;
+}
+
+bool AsyncLog::allow(Site &site)
+{
+    // Fixed one-second window per site. Racing tasks can let a line too
+    // many through: the limit is a bound on noise, not a contract.
+    uint32_t now = millis();
+    if (now - site.window_start_ms >= 1000)
+    {
+        site.window_start_ms = now;
+        site.lines = 0;
+    }
+    if (site.lines >= SITE_LINES_PER_SECOND)
+    {
+        site.suppressed++;
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    site.lines++;
+    return true;
+}
+
+AsyncLog::Slot *AsyncLog::claim()
+{
+    uint32_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    while (true)
+    {
+        Slot *slot = &slots[pos & (SLOTS - 1)];
+        int32_t diff = (int32_t)(slot->sequence.load(std::memory_order_acquire) - pos);
+        if (diff == 0)
+        {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                return slot;
+            }
+        }
+        else if (diff < 0)
+        {
+            // Full: the drain task is behind
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        else
+        {
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void AsyncLog::publish(Slot *slot)
+{
+    uint32_t pos = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+void AsyncLog::vlog(Site &site, const char *format, va_list args)
+{
+    uint16_t skipped = site.suppressed;
+    if (!allow(site))
+    {
+        return;
+    }
+
+    Slot *slot = claim();
+    if (!slot)
+    {
+        return;
+    }
+
+    int length = 0;
+    if (skipped)
+    {
+        site.suppressed = 0;
+        length = snprintf(slot->text, TEXT_SIZE, "⏳ (%u lines suppressed) ", skipped);
+        length = constrain(length, 0, TEXT_SIZE - 1);
+    }
+    int body = vsnprintf(slot->text + length, TEXT_SIZE - length, format, args);
+    length = constrain(length + max(body, 0), 0, TEXT_SIZE - 1);
+    slot->length = length;
+    publish(slot);
+}
+
+void AsyncLog::printf(Site &site, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vlog(site, format, args);
+    va_end(args);
+}
+
+void AsyncLog::println(Site &site, const char *text)
+{
+    printf(site, "%s\n", text);
+}
+
+void AsyncLog::drain()
+{
+    while (true)
+    {
+        Slot *slot = &slots[dequeue_pos & (SLOTS - 1)];
+        if (slot->sequence.load(std::memory_order_acquire) != dequeue_pos + 1)
+        {
+            return;
+        }
+
+        Serial.write((const uint8_t *)slot->text, slot->length);
+        written.fetch_add(1, std::memory_order_relaxed);
+
+        // Free the slot for the lap after this one
+        slot->sequence.store(dequeue_pos + SLOTS, std::memory_order_release);
+        dequeue_pos++;
+    }
+}
+
+void AsyncLog::drainTask(void *parameter)
+{
+    AsyncLog *log = static_cast<AsyncLog *>(parameter);
+    while (true)
+    {
+        log->drain();
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef ASYNCLOG_H
+#define ASYNCLOG_H
+
+#include "Arduino.h"
+#include <atomic>
+
+// Non-blocking log: callers format into a slot of a lock-free ring,
+// a low-priority task on Core 0 writes the slots to Serial.
+//
+// Any task may log (bounded multi-producer queue: a slot is claimed with
+// one compare-and-swap, published with a sequence number). A full ring
+// drops the line and counts it, it never waits. Each call site has its
+// own limit of SITE_LINES_PER_SECOND; lines over it are counted and
+// reported by the next line that gets through.
+class AsyncLog
+{
+public:
+    static const uint16_t SLOTS = 128;     // power of two, room for the boot log
+    static const uint16_t TEXT_SIZE = 120; // per line, longer lines are cut
+    static const uint8_t SITE_LINES_PER_SECOND = 10;
+    static const uint32_t STACK_SIZE = 3072;
+
+    // Per call site state, zero-initialized statics (see LOG_PRINTF)
+    struct Site
+    {
+        uint32_t window_start_ms;
+        uint16_t lines;
+        uint16_t suppressed;
+    };
+
+private:
+    struct Slot
+    {
+        std::atomic<uint32_t> sequence;
+        uint16_t length;
+        char text[TEXT_SIZE];
+    };
+
+    Slot slots[SLOTS];
+    std::atomic<uint32_t> enqueue_pos;
+    uint32_t dequeue_pos; // drain task only
+    TaskHandle_t task;
+
+    std::atomic<uint32_t> written;
+    std::atomic<uint32_t> dropped;
+    std::atomic<uint32_t> suppressed;
+
+public:
+    AsyncLog();
+
+    // Starts the drain task (Core 0, priority 0). Lines logged before are
+    // kept in the ring until it runs.
+    bool begin();
+
+    void printf(Site &site, const char *format, ...) __attribute__((format(printf, 3, 4)));
+    void println(Site &site, const char *text);
+
+    uint32_t getWritten() const { return written; }
+    uint32_t getDropped() const { return dropped; }
+    uint32_t getSuppressed() const { return suppressed; }
+    TaskHandle_t getTask() const { return task; }
+
+private:
+    // Writes what is queued (drain task only: single consumer)
+    void drain();
+    bool allow(Site &site);
+    Slot *claim();
+    void publish(Slot *slot);
+    void vlog(Site &site, const char *format, va_list args);
+    static void drainTask(void *parameter);
+};
+
+extern AsyncLog asyncLog;
+
+// One rate-limit state per call site
+#define LOG_PRINTF(...)                         \
+    do                                          \
+    {                                           \
+        static AsyncLog::Site log_site;         \
+        asyncLog.printf(log_site, __VA_ARGS__); \
+    } while (0)
+
+#define LOG_PRINTLN(text)                       \
+    do                                          \
+    {                                           \
+        static AsyncLog::Site log_site;         \
+        asyncLog.println(log_site, text);       \
+    } while (0)
+
+#endif // ASYNCLOG_H
@@ -0,0 +1,48 @@
+#ifndef AUDIOCONFIG_H
+#define AUDIOCONFIG_H
+
+#include "Arduino.h"
+#include "AudioTools.h"
+
+// The one place the audio format is decided. Override per build in
+// platformio.ini build_flags:
+//   -DSYNTH_SAMPLE_RATE=48000   output rate
+//   -DSYNTH_OVERSAMPLING=2      VCOs run at twice the output rate and are
+//                               brought down by a half-band decimator
+//   -DSYNTH_DUAL_CORE=1         voices and reverb split over both cores
+#ifndef SYNTH_SAMPLE_RATE
+#define SYNTH_SAMPLE_RATE 44100
+#endif
+
+#ifndef SYNTH_OVERSAMPLING
+#define SYNTH_OVERSAMPLING 1
+#endif
+
+#ifndef SYNTH_DUAL_CORE
+#define SYNTH_DUAL_CORE 0
+#endif
+
+#if SYNTH_OVERSAMPLING != 1 && SYNTH_OVERSAMPLING != 2
+#error "SYNTH_OVERSAMPLING must be 1 or 2"
+#endif
+
+static const uint32_t AUDIO_SAMPLE_RATE = SYNTH_SAMPLE_RATE;
+static const uint8_t AUDIO_CHANNELS = 2;
+static const uint8_t AUDIO_BITS = 16;
+static const uint8_t AUDIO_OVERSAMPLING = SYNTH_OVERSAMPLING;
+static const bool AUDIO_DUAL_CORE = SYNTH_DUAL_CORE != 0;
+
+// Output format: I2S, render bus, sequencer clock
+inline audio_tools::AudioInfo defaultAudioInfo()
+{
+    return audio_tools::AudioInfo(AUDIO_SAMPLE_RATE, AUDIO_CHANNELS, AUDIO_BITS);
+}
+
+// Format the VCOs are generated in (the sample layer stays at the output rate)
+inline audio_tools::AudioInfo oscillatorInfo(audio_tools::AudioInfo output)
+{
+    output.sample_rate *= AUDIO_OVERSAMPLING;
+    return output;
+}
+
+#endif // AUDIOCONFIG_H
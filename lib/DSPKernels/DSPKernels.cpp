@@ -0,0 +1,148 @@
+#include <DSPKernels.h>
+
+#ifdef __GNUC__
+#define RESTRICT __restrict__
+#else
+#define RESTRICT
+#endif
+
+static inline int16_t saturate(int32_t value)
+{
+    return value > 32767 ? 32767 : value < -32768 ? -32768 : (int16_t)value;
+}
+
+// Gain ramp in Q15 << 16: exact start, fixed step per frame
+static inline int32_t rampStep(int32_t start_q15, int32_t end_q15, uint32_t frames)
+{
+    return frames ? (int32_t)((((int64_t)end_q15 - start_q15) << 16) / (int64_t)frames) : 0;
+}
+
+// Q31 to int16: (value + 2^15) >> 16 without overflow
+static inline int16_t roundQ31(int32_t value)
+{
+    return saturate(((value >> 15) + 1) >> 1);
+}
+
+// ---- Element-wise: plain loops, left to the compiler ----
+
+void DSPKernels::mixAccumulate(int32_t *RESTRICT acc, const int16_t *RESTRICT src, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        acc[i] += src[i];
+    }
+}
+
+void DSPKernels::accumulate(int32_t *RESTRICT acc, const int32_t *RESTRICT src, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        acc[i] += src[i];
+    }
+}
+
+void DSPKernels::saturate16(const int32_t *RESTRICT src, int16_t *RESTRICT dst, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        dst[i] = saturate(src[i]);
+    }
+}
+
+void DSPKernels::int16ToQ31(const int16_t *RESTRICT src, int32_t *RESTRICT dst, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        dst[i] = (int32_t)src[i] << 16;
+    }
+}
+
+void DSPKernels::q31ToInt16(const int32_t *RESTRICT src, int16_t *RESTRICT dst, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        dst[i] = roundQ31(src[i]);
+    }
+}
+
+// ---- Reference: one sample per iteration, defines the results ----
+
+void DSPKernels::gainRampReference(int16_t *buffer, uint32_t frames, uint8_t channels, int32_t start_q15, int32_t end_q15)
+{
+    int32_t step = rampStep(start_q15, end_q15, frames);
+    int32_t gain = start_q15 << 16;
+    for (uint32_t f = 0; f < frames; f++)
+    {
+        int32_t g = gain >> 16;
+        for (uint8_t c = 0; c < channels; c++)
+        {
+            buffer[f * channels + c] = (int16_t)((buffer[f * channels + c] * g) >> 15);
+        }
+        gain += step;
+    }
+}
+
+void DSPKernels::interleaveReference(const int16_t *mono, int16_t *dst, uint32_t frames, uint8_t channels)
+{
+    for (uint32_t f = 0; f < frames; f++)
+    {
+        for (uint8_t c = 0; c < channels; c++)
+        {
+            dst[f * channels + c] = mono[f];
+        }
+    }
+}
+
+// ---- Fast paths: the common shapes without the generic loops ----
+
+void DSPKernels::gainRamp(int16_t *buffer, uint32_t frames, uint8_t channels, int32_t start_q15, int32_t end_q15)
+{
+    int32_t step = rampStep(start_q15, end_q15, frames);
+
+    // Constant gain: one flat loop over every sample
+    if (step == 0)
+    {
+        int32_t g = start_q15;
+        uint32_t count = frames * channels;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            buffer[i] = (int16_t)((buffer[i] * g) >> 15);
+        }
+        return;
+    }
+
+    int32_t gain = start_q15 << 16;
+    if (channels == 2)
+    {
+        for (uint32_t f = 0; f < frames; f++)
+        {
+            int32_t g = gain >> 16;
+            buffer[2 * f] = (int16_t)((buffer[2 * f] * g) >> 15);
+            buffer[2 * f + 1] = (int16_t)((buffer[2 * f + 1] * g) >> 15);
+            gain += step;
+        }
+        return;
+    }
+
+    gainRampReference(buffer, frames, channels, start_q15, end_q15);
+}
+
+void DSPKernels::interleave(const int16_t *RESTRICT mono, int16_t *RESTRICT dst, uint32_t frames, uint8_t channels)
+{
+    if (channels == 2)
+    {
+        for (uint32_t f = 0; f < frames; f++)
+        {
+            dst[2 * f] = mono[f];
+            dst[2 * f + 1] = mono[f];
+        }
+    }
+    else if (channels == 1)
+    {
+        memcpy(dst, mono, frames * sizeof(int16_t));
+    }
+    else
+    {
+        interleaveReference(mono, dst, frames, channels);
+    }
+}
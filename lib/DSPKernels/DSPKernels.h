@@ -0,0 +1,39 @@
+#ifndef DSPKERNELS_H
+#define DSPKERNELS_H
+
+// Plain C++ only: also built by the native test environment
+#include <stdint.h>
+#include <string.h>
+
+// Block kernels shared by the render path: mix-accumulate, gain ramp,
+// saturation, Q31 conversion and interleave.
+//
+// The element-wise kernels are plain loops: GCC already vectorizes them
+// on the host and turns them into zero-overhead loops on the ESP32, and
+// hand-unrolled copies measured no faster. gainRamp and interleave have
+// a fast path per common shape (constant gain, stereo) next to a generic
+// reference that defines their result bit for bit.
+class DSPKernels
+{
+public:
+    // acc[i] += src[i]
+    static void mixAccumulate(int32_t *acc, const int16_t *src, uint32_t count);
+    // acc[i] += src[i]
+    static void accumulate(int32_t *acc, const int32_t *src, uint32_t count);
+    // Interleaved buffer times a Q15 gain moving linearly from start to end
+    // over the frames (start == end: constant gain)
+    static void gainRamp(int16_t *buffer, uint32_t frames, uint8_t channels, int32_t start_q15, int32_t end_q15);
+    // 32-bit bus value saturated to int16
+    static void saturate16(const int32_t *src, int16_t *dst, uint32_t count);
+    // Q31 <-> int16, rounded and saturated on the way down
+    static void int16ToQ31(const int16_t *src, int32_t *dst, uint32_t count);
+    static void q31ToInt16(const int32_t *src, int16_t *dst, uint32_t count);
+    // Mono to interleaved, every channel gets the sample
+    static void interleave(const int16_t *mono, int16_t *dst, uint32_t frames, uint8_t channels);
+
+    // Reference versions of the kernels with fast paths
+    static void gainRampReference(int16_t *buffer, uint32_t frames, uint8_t channels, int32_t start_q15, int32_t end_q15);
+    static void interleaveReference(const int16_t *mono, int16_t *dst, uint32_t frames, uint8_t channels);
+};
+
+#endif // DSPKERNELS_H
@@ -0,0 +1,235 @@
+#include <Envelope.h>
+
+// Below this (~1 LSB at 16 bits) a segment counts as finished
+static const float SILENCE = 3e-5f;
+
+// ln(1000): exponential decay and release times are 60 dB falls
+static const float LN_1000 = 6.9078f;
+
+// Exponential attack: RC charge towards ATTACK_TARGET, cut at 1.0
+static const float ATTACK_TARGET = 1.2f;
+
+Envelope::Envelope()
+    : input(nullptr), info(defaultAudioInfo()),
+      attack_seconds(0.01f), decay_seconds(0.2f), sustain_level(0.7f), release_seconds(1.0f),
+      attack_shape(LINEAR), decay_shape(EXPONENTIAL),
+      stage(IDLE), level(0), velocity(1.0f), coef_a(1.0f), coef_b(0), target(0), remaining(0)
+{
+}
+
+bool Envelope::begin(audio_tools::AudioInfo audioInfo)
+{
+    info = audioInfo;
+    if (info.bits_per_sample != 16)
+    {
+        LOG_PRINTLN("Error: Envelope supports 16-bit audio only");
+        return false;
+    }
+    enterStage(IDLE);
+    return true;
+}
+
+void Envelope::setADSR(float attack, float decay, float sustain, float release)
+{
+    attack_seconds = max(attack, 0.0005f);
+    decay_seconds = max(decay, 0.0005f);
+    release_seconds = max(release, 0.0005f);
+
+    sustain = constrain(sustain, 0.0f, 1.0f);
+    bool glide = stage == SUSTAIN && sustain != sustain_level;
+    sustain_level = sustain;
+    if (glide)
+    {
+        enterStage(DECAY);
+    }
+}
+
+void Envelope::setShapes(Shape attack, Shape decayRelease)
+{
+    attack_shape = attack;
+    decay_shape = decayRelease;
+}
+
+void Envelope::keyOn(float noteVelocity)
+{
+    noteVelocity = constrain(noteVelocity, 0.0f, 1.0f);
+
+    // Retrigger from the current gain: no click when the velocity changes
+    if (stage != IDLE && noteVelocity > 0)
+    {
+        level = min(level * velocity / noteVelocity, 1.0f);
+    }
+    velocity = noteVelocity;
+    enterStage(ATTACK);
+}
+
+void Envelope::keyOff()
+{
+    if (stage != IDLE && stage != RELEASE)
+    {
+        enterStage(RELEASE);
+    }
+}
+
+uint32_t Envelope::samplesFor(float seconds) const
+{
+    return max((uint32_t)(seconds * info.sample_rate), (uint32_t)1);
+}
+
+void Envelope::enterStage(Stage next)
+{
+    stage = next;
+    float rate = info.sample_rate;
+
+    switch (next)
+    {
+    case ATTACK:
+        target = 1.0f;
+        if (attack_shape == LINEAR)
+        {
+            // Full 0..1 ramp in attack_seconds, shortened by the current level
+            remaining = samplesFor(attack_seconds * (1.0f - level));
+            coef_a = 1.0f;
+            coef_b = (1.0f - level) / remaining;
+        }
+        else
+        {
+            // 0 -> 1 takes attack_seconds: a^n = (T - 1) / T
+            coef_a = expf(logf((ATTACK_TARGET - 1.0f) / ATTACK_TARGET) / (attack_seconds * rate));
+            coef_b = ATTACK_TARGET * (1.0f - coef_a);
+            float ratio = (ATTACK_TARGET - 1.0f) / (ATTACK_TARGET - level);
+            remaining = max((uint32_t)(logf(ratio) / logf(coef_a)), (uint32_t)1);
+        }
+        break;
+
+    case DECAY:
+        target = sustain_level;
+        if (decay_shape == LINEAR)
+        {
+            remaining = samplesFor(decay_seconds * fabsf(level - sustain_level));
+            coef_a = 1.0f;
+            coef_b = (sustain_level - level) / remaining;
+        }
+        else
+        {
+            coef_a = expf(-LN_1000 / (decay_seconds * rate));
+            coef_b = sustain_level * (1.0f - coef_a);
+            float distance = fabsf(level - sustain_level);
+            remaining = distance > SILENCE ? (uint32_t)(logf(SILENCE / distance) / logf(coef_a)) + 1 : 1;
+        }
+        break;
+
+    case SUSTAIN:
+        // Nothing left to hold: a percussive note ends here
+        if (sustain_level < SILENCE)
+        {
+            enterStage(IDLE);
+            return;
+        }
+        level = sustain_level;
+        target = sustain_level;
+        coef_a = 1.0f;
+        coef_b = 0;
+        remaining = UINT32_MAX;
+        break;
+
+    case RELEASE:
+        target = 0;
+        if (decay_shape == LINEAR)
+        {
+            remaining = samplesFor(release_seconds * level);
+            coef_a = 1.0f;
+            coef_b = -level / remaining;
+        }
+        else
+        {
+            coef_a = expf(-LN_1000 / (release_seconds * rate));
+            coef_b = 0;
+            remaining = level > SILENCE ? (uint32_t)(logf(SILENCE / level) / logf(coef_a)) + 1 : 1;
+        }
+        break;
+
+    case IDLE:
+    default:
+        level = 0;
+        target = 0;
+        coef_a = 1.0f;
+        coef_b = 0;
+        remaining = UINT32_MAX;
+        break;
+    }
+}
+
+const char *Envelope::stageName(Stage s)
+{
+    switch (s)
+    {
+    case ATTACK:
+        return "attack";
+    case DECAY:
+        return "decay";
+    case SUSTAIN:
+        return "sustain";
+    case RELEASE:
+        return "release";
+    default:
+        return "idle";
+    }
+}
+
+size_t Envelope::readBytes(uint8_t *data, size_t len)
+{
+    // Idle: the oscillators behind are not even read
+    if (!input || stage == IDLE)
+    {
+        memset(data, 0, len);
+        return len;
+    }
+
+    size_t bytes = input->readBytes(data, len);
+    int16_t *samples = (int16_t *)data;
+    uint8_t channels = info.channels;
+    uint32_t frames = bytes / (sizeof(int16_t) * channels);
+    uint32_t done = 0;
+
+    while (done < frames)
+    {
+        if (stage == IDLE)
+        {
+            memset(samples + done * channels, 0, (frames - done) * channels * sizeof(int16_t));
+            break;
+        }
+
+        // Run the segment up to its end or the end of the block
+        uint32_t n = min(remaining, frames - done);
+        float a = coef_a;
+        float b = coef_b;
+        float l = level;
+        float v = velocity;
+        int16_t *frame = samples + done * channels;
+        for (uint32_t i = 0; i < n; i++)
+        {
+            l = l * a + b;
+            float gain = l * v;
+            for (uint8_t c = 0; c < channels; c++)
+            {
+                frame[c] = (int16_t)(frame[c] * gain);
+            }
+            frame += channels;
+        }
+        level = l;
+        done += n;
+
+        if (stage != SUSTAIN)
+        {
+            remaining -= n;
+            if (remaining == 0)
+            {
+                level = target;
+                enterStage(stage == ATTACK ? DECAY : stage == DECAY ? SUSTAIN : IDLE);
+            }
+        }
+    }
+
+    return bytes;
+}
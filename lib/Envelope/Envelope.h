@@ -0,0 +1,85 @@
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#include "Arduino.h"
+#include "AudioTools.h"
+#include <AudioConfig.h>
+#include <AsyncLog.h>
+
+// ADSR envelope applied to the stream it pulls from, times in seconds.
+//
+// Every segment is level = level * a + b: a linear ramp (a = 1) or an
+// exponential approach to the segment target. a, b and the segment length
+// in samples are computed once when a stage starts, so a sample costs one
+// multiply-add and the stage change is a counter reaching zero.
+// Exponential decay and release times are 60 dB falls (T60), like the
+// bowl partials; an exponential attack is an RC charge towards 1.2,
+// stopped at 1.
+class Envelope : public audio_tools::AudioStream
+{
+public:
+    enum Stage
+    {
+        IDLE,
+        ATTACK,
+        DECAY,
+        SUSTAIN,
+        RELEASE
+    };
+
+    enum Shape
+    {
+        LINEAR,
+        EXPONENTIAL
+    };
+
+private:
+    audio_tools::AudioStream *input;
+    audio_tools::AudioInfo info;
+
+    // Settings
+    float attack_seconds;
+    float decay_seconds;
+    float sustain_level;
+    float release_seconds;
+    Shape attack_shape;
+    Shape decay_shape; // decay and release
+
+    // Running segment
+    Stage stage;
+    float level;    // 0..1, before velocity
+    float velocity;
+    float coef_a;
+    float coef_b;
+    float target;
+    uint32_t remaining; // samples left in the segment
+
+public:
+    Envelope();
+
+    bool begin(audio_tools::AudioInfo audioInfo);
+    void setInput(audio_tools::AudioStream &stream) { input = &stream; }
+
+    // New times apply from the next stage; a new sustain level glides
+    void setADSR(float attack, float decay, float sustain, float release);
+    void setShapes(Shape attack, Shape decayRelease);
+
+    void keyOn(float noteVelocity = 1.0f);
+    void keyOff();
+
+    bool isActive() const { return stage != IDLE; }
+    Stage getStage() const { return stage; }
+    float getLevel() const { return level * velocity; }
+    static const char *stageName(Stage s);
+
+    // AudioStream
+    size_t readBytes(uint8_t *data, size_t len) override;
+    size_t write(const uint8_t *data, size_t len) override { return 0; }
+    int available() override { return input ? input->available() : 0; }
+
+private:
+    void enterStage(Stage next);
+    uint32_t samplesFor(float seconds) const;
+};
+
+#endif // ENVELOPE_H
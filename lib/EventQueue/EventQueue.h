@@ -0,0 +1,149 @@
+#ifndef EVENTQUEUE_H
+#define EVENTQUEUE_H
+
+#include "Arduino.h"
+
+// Timed event on the render sample clock
+struct ClockEvent
+{
+    // Same-sample order follows the enum: a gate closes, parameters and
+    // pattern swaps apply, then the new note starts with them
+    enum Type : uint8_t
+    {
+        GATE_OFF,
+        PARAMETER,
+        PATTERN_SWAP,
+        NOTE_ON
+    };
+
+    uint64_t time;      // samples
+    uint32_t order;     // insertion order, ties on equal time and type
+    uint8_t type;
+    uint8_t track;
+    uint16_t id;        // parameter or pattern number
+    float value;
+};
+
+// Fixed-size event list sorted by time (binary min-heap).
+//
+// Push and pop are O(log SIZE) with no allocation; the earliest event is
+// always at the top, so "time to next event" is a single read. Not
+// thread-safe: the owner serialises access.
+template <uint16_t SIZE>
+class EventQueue
+{
+private:
+    ClockEvent heap[SIZE];
+    uint16_t count;
+    uint32_t next_order;
+    uint32_t overflows;
+
+public:
+    EventQueue() : count(0), next_order(0), overflows(0) {}
+
+    void clear() { count = 0; }
+    bool empty() const { return count == 0; }
+    uint16_t size() const { return count; }
+    uint32_t getOverflows() const { return overflows; }
+
+    const ClockEvent &top() const { return heap[0]; }
+
+    bool push(ClockEvent event)
+    {
+        if (count >= SIZE)
+        {
+            overflows++;
+            return false;
+        }
+
+        event.order = next_order++;
+
+        // Sift up
+        uint16_t i = count++;
+        while (i > 0)
+        {
+            uint16_t parent = (i - 1) / 2;
+            if (!before(event, heap[parent]))
+            {
+                break;
+            }
+            heap[i] = heap[parent];
+            i = parent;
+        }
+        heap[i] = event;
+        return true;
+    }
+
+    bool pop(ClockEvent &event)
+    {
+        if (count == 0)
+        {
+            return false;
+        }
+
+        event = heap[0];
+        heap[0] = heap[--count];
+        siftDown(0);
+        return true;
+    }
+
+    // Drop every event matching the predicate, keeping the others in order
+    template <typename Predicate>
+    void removeIf(Predicate remove)
+    {
+        uint16_t kept = 0;
+        for (uint16_t i = 0; i < count; i++)
+        {
+            if (!remove(heap[i]))
+            {
+                heap[kept++] = heap[i];
+            }
+        }
+        count = kept;
+
+        for (int32_t i = count / 2 - 1; i >= 0; i--)
+        {
+            siftDown(i);
+        }
+    }
+
+private:
+    void siftDown(uint16_t i)
+    {
+        ClockEvent moving = heap[i];
+        while (true)
+        {
+            uint16_t child = 2 * i + 1;
+            if (child >= count)
+            {
+                break;
+            }
+            if (child + 1 < count && before(heap[child + 1], heap[child]))
+            {
+                child++;
+            }
+            if (!before(heap[child], moving))
+            {
+                break;
+            }
+            heap[i] = heap[child];
+            i = child;
+        }
+        heap[i] = moving;
+    }
+
+    static bool before(const ClockEvent &a, const ClockEvent &b)
+    {
+        if (a.time != b.time)
+        {
+            return a.time < b.time;
+        }
+        if (a.type != b.type)
+        {
+            return a.type < b.type;
+        }
+        return (int32_t)(a.order - b.order) < 0;
+    }
+};
+
+#endif // EVENTQUEUE_H
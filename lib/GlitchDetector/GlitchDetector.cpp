@@ -0,0 +1,218 @@
+#include <GlitchDetector.h>
+
+static const int32_t FULL_SCALE = 32767;
+
+GlitchDetector::GlitchDetector()
+    : sample_rate(AUDIO_SAMPLE_RATE), channels(2), enabled(false),
+      click_floor(2048), click_ratio(4), dc_threshold(4096),
+      dc_count(0), dc_valid(false), frame_count(0), lost_events(0),
+      step(0), pattern(0), command("start"), command_ms(0),
+      history_pos(0), capture_remaining(0), snapshot_ready(false)
+{
+    memset(previous, 0, sizeof(previous));
+    memset(slope_peak, 0, sizeof(slope_peak));
+    memset(dc_sum, 0, sizeof(dc_sum));
+    memset(dc_mean, 0, sizeof(dc_mean));
+    memset(clip_run, 0, sizeof(clip_run));
+    memset((void *)counts, 0, sizeof(counts));
+    memset(history, 0, sizeof(history));
+    memset(snapshot, 0, sizeof(snapshot));
+    memset(&snapshot_event, 0, sizeof(snapshot_event));
+    for (uint8_t t = 0; t < NUM_EVENT_TYPES; t++)
+    {
+        last_event_frame[t] = (uint32_t)-HOLDOFF_FRAMES;
+    }
+}
+
+bool GlitchDetector::begin(uint32_t rate, uint8_t numChannels)
+{
+    if (numChannels == 0 || numChannels > MAX_CHANNELS)
+    {
+        LOG_PRINTLN("Error: GlitchDetector supports mono or stereo only");
+        return false;
+    }
+    sample_rate = rate;
+    channels = numChannels;
+    command_ms = millis();
+    enabled = true;
+    return true;
+}
+
+void GlitchDetector::setClickThreshold(int32_t floor, uint8_t ratio)
+{
+    click_floor = max(floor, (int32_t)1);
+    click_ratio = max(ratio, (uint8_t)1);
+}
+
+void GlitchDetector::noteCommand(const char *name)
+{
+    command_ms = millis();
+    command = name;
+}
+
+const char *GlitchDetector::typeName(EventType type)
+{
+    switch (type)
+    {
+    case DISCONTINUITY:
+        return "discontinuity";
+    case DC_JUMP:
+        return "DC jump";
+    case CLIPPED_RUN:
+        return "clipped run";
+    case UNDERRUN:
+        return "underrun";
+    default:
+        return "?";
+    }
+}
+
+void GlitchDetector::report(EventType type, int32_t value, uint32_t frame)
+{
+    counts[type] = counts[type] + 1;
+
+    // One event per type per holdoff: a burst is one glitch
+    if (frame - last_event_frame[type] < HOLDOFF_FRAMES)
+    {
+        return;
+    }
+    last_event_frame[type] = frame;
+
+    Event event;
+    event.type = type;
+    event.value = value;
+    event.frame = frame;
+    event.time_ms = millis();
+    event.step = step;
+    event.pattern = pattern;
+    event.command = command;
+    event.command_age_ms = event.time_ms - command_ms;
+    event.snapshot = false;
+
+    // First event while no snapshot is pending: keep recording half a
+    // snapshot more, the event ends up in the middle
+    if (!snapshot_ready && capture_remaining == 0)
+    {
+        event.snapshot = true;
+        snapshot_event = event;
+        capture_remaining = SNAPSHOT_FRAMES / 2;
+    }
+
+    if (!events.push(event))
+    {
+        lost_events = lost_events + 1;
+    }
+}
+
+void GlitchDetector::freezeSnapshot()
+{
+    // Oldest frame first
+    uint32_t samples = SNAPSHOT_FRAMES * channels;
+    uint32_t start = history_pos * channels;
+    memcpy(snapshot, history + start, (samples - start) * sizeof(int16_t));
+    memcpy(snapshot + (samples - start), history, start * sizeof(int16_t));
+    snapshot_ready = true;
+}
+
+void GlitchDetector::addUnderrun(uint32_t late_us)
+{
+    if (enabled)
+    {
+        report(UNDERRUN, late_us, frame_count);
+    }
+}
+
+void GlitchDetector::process(const int16_t *samples, uint32_t frames)
+{
+    if (!enabled)
+    {
+        return;
+    }
+
+    for (uint32_t f = 0; f < frames; f++)
+    {
+        const int16_t *frame = samples + f * channels;
+        int16_t *stored = history + history_pos * channels;
+
+        for (uint8_t c = 0; c < channels; c++)
+        {
+            int32_t x = frame[c];
+            stored[c] = x;
+
+            // Second difference against its decaying recent peak (~50 ms)
+            int32_t slope = abs(x - 2 * previous[c][0] + previous[c][1]);
+            previous[c][1] = previous[c][0];
+            previous[c][0] = x;
+            if (slope > click_floor && slope > slope_peak[c] * click_ratio)
+            {
+                report(DISCONTINUITY, slope, frame_count);
+            }
+            slope_peak[c] = max(slope, slope_peak[c] - (slope_peak[c] >> 11) - 1);
+
+            if (x >= FULL_SCALE || x <= -FULL_SCALE)
+            {
+                if (++clip_run[c] == CLIP_RUN)
+                {
+                    report(CLIPPED_RUN, CLIP_RUN, frame_count);
+                }
+            }
+            else
+            {
+                clip_run[c] = 0;
+            }
+
+            dc_sum[c] += x;
+        }
+
+        if (++dc_count == DC_WINDOW)
+        {
+            for (uint8_t c = 0; c < channels; c++)
+            {
+                int32_t mean = dc_sum[c] / DC_WINDOW;
+                if (dc_valid && abs(mean - dc_mean[c]) > dc_threshold)
+                {
+                    report(DC_JUMP, mean - dc_mean[c], frame_count);
+                }
+                dc_mean[c] = mean;
+                dc_sum[c] = 0;
+            }
+            dc_count = 0;
+            dc_valid = true;
+        }
+
+        if (++history_pos == SNAPSHOT_FRAMES)
+        {
+            history_pos = 0;
+        }
+        if (capture_remaining && --capture_remaining == 0)
+        {
+            freezeSnapshot();
+        }
+        frame_count++;
+    }
+}
+
+bool GlitchDetector::saveSnapshot(fs::FS &fs, const char *path)
+{
+    if (!snapshot_ready)
+    {
+        return false;
+    }
+
+    File file = fs.open(path, FILE_WRITE);
+    if (!file)
+    {
+        LOG_PRINTF("⚠️ Cannot write glitch snapshot %s\n", path);
+        return false;
+    }
+
+    uint32_t data_bytes = SNAPSHOT_FRAMES * channels * sizeof(int16_t);
+    uint8_t header[WavHeader::SIZE];
+    WavHeader::fill(header, sample_rate, channels, data_bytes);
+    bool ok = file.write(header, sizeof(header)) == sizeof(header) &&
+              file.write((const uint8_t *)snapshot, data_bytes) == data_bytes;
+    file.close();
+
+    releaseSnapshot();
+    return ok;
+}
@@ -0,0 +1,137 @@
+#ifndef GLITCHDETECTOR_H
+#define GLITCHDETECTOR_H
+
+#include "Arduino.h"
+#include "FS.h"
+#include <AudioConfig.h>
+#include <AsyncLog.h>
+#include <SPSCRing.h>
+#include <WavHeader.h>
+
+// Watches the final 16-bit output for the things that sound like clicks.
+//
+// - Discontinuity: a second difference well above the recent ones. The
+//   reference decays over ~50 ms, so a saw or a resonant filter that is
+//   sharp all the time does not trigger, a step in a smooth signal does.
+// - DC jump: the mean over DC_WINDOW frames moves by more than a threshold.
+// - Clipped run: CLIP_RUN samples in a row at full scale.
+// - Underrun: reported by the audio task when a block came late.
+//
+// Each event carries the output frame, the sequencer step, the pattern
+// and the last control command, and goes into a small ring read from
+// loop(). The last SNAPSHOT_FRAMES of output are kept in a ring; the
+// first event while no snapshot is pending freezes it with the event in
+// the middle, for saveSnapshot() to write as a WAV file.
+//
+// The per-sample work is a few integer operations per channel.
+class GlitchDetector
+{
+public:
+    enum EventType : uint8_t
+    {
+        DISCONTINUITY = 0,
+        DC_JUMP,
+        CLIPPED_RUN,
+        UNDERRUN,
+        NUM_EVENT_TYPES
+    };
+
+    struct Event
+    {
+        EventType type;
+        int32_t value;       // second difference, mean change, run length or late us
+        uint32_t frame;      // output frames since begin()
+        uint32_t time_ms;
+        uint16_t step;
+        uint8_t pattern;
+        const char *command; // last control command (static string)
+        uint32_t command_age_ms;
+        bool snapshot;       // this event froze the audio snapshot
+    };
+
+    static const uint8_t MAX_CHANNELS = 2;
+    static const uint8_t MAX_EVENTS = 16;
+    static const uint16_t SNAPSHOT_FRAMES = 1024;
+    static const uint16_t DC_WINDOW = 2048;
+    static const uint8_t CLIP_RUN = 8;
+    static const uint32_t HOLDOFF_FRAMES = 4410; // one event per type per ~100 ms
+
+private:
+    uint32_t sample_rate;
+    uint8_t channels;
+    volatile bool enabled;
+
+    // Thresholds
+    int32_t click_floor;
+    uint8_t click_ratio;
+    int32_t dc_threshold;
+
+    // Per channel state
+    int32_t previous[MAX_CHANNELS][2];
+    int32_t slope_peak[MAX_CHANNELS]; // decaying peak of |second difference|
+    int32_t dc_sum[MAX_CHANNELS];
+    int32_t dc_mean[MAX_CHANNELS];
+    uint16_t clip_run[MAX_CHANNELS];
+    uint16_t dc_count;
+    bool dc_valid;
+
+    uint32_t frame_count;
+    uint32_t last_event_frame[NUM_EVENT_TYPES];
+    volatile uint32_t counts[NUM_EVENT_TYPES];
+    volatile uint32_t lost_events;
+
+    // Context, set from the control side
+    volatile uint16_t step;
+    volatile uint8_t pattern;
+    const char *volatile command;
+    volatile uint32_t command_ms;
+
+    SPSCRing<Event, MAX_EVENTS> events;
+
+    // Output history and the frozen copy
+    int16_t history[SNAPSHOT_FRAMES * MAX_CHANNELS];
+    uint16_t history_pos;
+    int16_t snapshot[SNAPSHOT_FRAMES * MAX_CHANNELS];
+    uint16_t capture_remaining; // frames still to record after the event
+    volatile bool snapshot_ready;
+    Event snapshot_event;
+
+public:
+    GlitchDetector();
+
+    bool begin(uint32_t rate, uint8_t numChannels);
+
+    void setEnabled(bool enable) { enabled = enable; }
+    bool isEnabled() const { return enabled; }
+
+    // floor: smallest second difference reported; ratio: how far above the
+    // recent ones it must be
+    void setClickThreshold(int32_t floor, uint8_t ratio);
+    void setDCThreshold(int32_t threshold) { dc_threshold = threshold; }
+
+    // Control side context, stamped on the events
+    void setStep(uint16_t currentStep) { step = currentStep; }
+    void setPattern(uint8_t currentPattern) { pattern = currentPattern; }
+    void noteCommand(const char *name);
+
+    // Audio task: checks a block of interleaved output
+    void process(const int16_t *samples, uint32_t frames);
+    void addUnderrun(uint32_t late_us);
+
+    // Control side
+    bool readEvent(Event &event) { return events.pop(event); }
+    uint32_t getCount(EventType type) const { return counts[type]; }
+    uint32_t getLostEvents() const { return lost_events; }
+    static const char *typeName(EventType type);
+
+    bool hasSnapshot() const { return snapshot_ready; }
+    const Event &getSnapshotEvent() const { return snapshot_event; }
+    bool saveSnapshot(fs::FS &fs, const char *path);
+    void releaseSnapshot() { snapshot_ready = false; }
+
+private:
+    void report(EventType type, int32_t value, uint32_t frame);
+    void freezeSnapshot();
+};
+
+#endif // GLITCHDETECTOR_H
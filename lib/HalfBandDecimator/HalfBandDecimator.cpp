@@ -0,0 +1,76 @@
+#include <HalfBandDecimator.h>
+
+// Non-zero taps of one half, outermost first (Q15); the centre tap is 0.5.
+// 2 * sum(pairs) + centre = 32768: unity gain at DC.
+static const int32_t pair_taps[HalfBandDecimator::PAIRS] = {-4, 35, -124, 321, -708, 1441, -3050, 10281};
+static const int32_t CENTRE_TAP = 16384;
+
+HalfBandDecimator::HalfBandDecimator()
+    : input(nullptr), info(defaultAudioInfo())
+{
+    memset(work, 0, sizeof(work));
+}
+
+bool HalfBandDecimator::begin(audio_tools::AudioInfo audioInfo)
+{
+    info = audioInfo;
+    if (info.bits_per_sample != 16 || info.channels > MAX_CHANNELS)
+    {
+        LOG_PRINTLN("Error: HalfBandDecimator supports 16-bit mono/stereo only");
+        return false;
+    }
+    memset(work, 0, sizeof(work));
+    return true;
+}
+
+size_t HalfBandDecimator::readBytes(uint8_t *data, size_t len)
+{
+    int16_t *out = (int16_t *)data;
+    uint8_t channels = info.channels;
+    uint32_t frames = len / (sizeof(int16_t) * channels);
+
+    if (!input)
+    {
+        memset(data, 0, len);
+        return len;
+    }
+
+    // work = [HISTORY frames kept from the last pass | 2 * n new frames]
+    int16_t *fresh = work + HISTORY * channels;
+    uint32_t done = 0;
+    while (done < frames)
+    {
+        uint32_t n = min(frames - done, (uint32_t)BLOCK_FRAMES);
+        size_t want = 2 * n * channels * sizeof(int16_t);
+        size_t got = input->readBytes((uint8_t *)fresh, want);
+        if (got < want)
+        {
+            memset((uint8_t *)fresh + got, 0, want - got);
+        }
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            // Newest input of output i is fresh frame 2i+1: taps reach back 30 frames
+            const int16_t *newest = fresh + (2 * i + 1) * channels;
+            for (uint8_t c = 0; c < channels; c++)
+            {
+                const int16_t *x = newest + c;
+                int32_t acc = CENTRE_TAP * x[-(TAPS / 2) * channels];
+                for (uint8_t k = 0; k < PAIRS; k++)
+                {
+                    // Pair k: taps 2k and 30-2k
+                    int32_t pair = x[-(2 * k) * channels] + x[-(HISTORY - 2 * k) * channels];
+                    acc += pair_taps[k] * pair;
+                }
+                acc = (acc + (1 << 14)) >> 15;
+                out[(done + i) * channels + c] = constrain(acc, -32768, 32767);
+            }
+        }
+
+        // Keep the last HISTORY input frames for the next pass
+        memmove(work, work + 2 * n * channels, HISTORY * channels * sizeof(int16_t));
+        done += n;
+    }
+
+    return frames * channels * sizeof(int16_t);
+}
@@ -0,0 +1,42 @@
+#ifndef HALFBANDDECIMATOR_H
+#define HALFBANDDECIMATOR_H
+
+#include "Arduino.h"
+#include "AudioTools.h"
+#include <AudioConfig.h>
+#include <AsyncLog.h>
+
+// 2:1 decimator for the oversampled VCO path.
+//
+// 31-tap half-band FIR (Kaiser windowed): every other coefficient is zero
+// and the taps are symmetric, so each output sample costs one centre tap
+// plus 8 pre-added pairs, only evaluated at the output rate (polyphase).
+// Flat to 0.2 fs_in, -80 dB from 0.4 fs_in. Q15 integer arithmetic.
+class HalfBandDecimator : public audio_tools::AudioStream
+{
+public:
+    static const uint8_t TAPS = 31;
+    static const uint8_t HISTORY = TAPS - 1;
+    static const uint8_t PAIRS = 8;
+    static const uint16_t BLOCK_FRAMES = 64; // output frames per pass
+    static const uint8_t MAX_CHANNELS = 2;
+
+private:
+    audio_tools::AudioStream *input;
+    audio_tools::AudioInfo info; // output format
+    int16_t work[(HISTORY + 2 * BLOCK_FRAMES) * MAX_CHANNELS];
+
+public:
+    HalfBandDecimator();
+
+    // audioInfo is the output format, the input runs at twice its rate
+    bool begin(audio_tools::AudioInfo audioInfo);
+    void setInput(audio_tools::AudioStream &stream) { input = &stream; }
+
+    // AudioStream
+    size_t readBytes(uint8_t *data, size_t len) override;
+    size_t write(const uint8_t *data, size_t len) override { return 0; }
+    int available() override { return input ? input->available() / 2 : 0; }
+};
+
+#endif // HALFBANDDECIMATOR_H
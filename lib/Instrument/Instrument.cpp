@@ -1,18 +1,40 @@
 #include <Instrument.h>
 
+// 2^x for x in [0, 1], replaces pow() in centsToRatio()
+static const uint16_t EXP2_TABLE_SIZE = 256;
+static float exp2_table[EXP2_TABLE_SIZE + 1];
+static bool exp2_table_ready = false;
+
 Instrument::Instrument()
     : vco1(nullptr), vco2(nullptr), vco3(nullptr),
       stream1(nullptr), stream2(nullptr), stream3(nullptr),
-      mixer(nullptr), adsr(nullptr), effectStream(nullptr),
-      info(44100, 2, 16), fundamental_freq(440.0f),
+      envelope(nullptr),
+      info(defaultAudioInfo()), osc_info(oscillatorInfo(defaultAudioInfo())), decimator(nullptr),
+      filter(nullptr),
+      fundamental_freq(440.0f),
       vco1_level(1.0f),
       vco2_level(0.6f),
       vco3_level(0.3f),
       vco1_detune(12.0f), // Fundamental - no detune
       vco2_detune(5.0f),  // 2nd harmonic - slight sharp for slow beats
       vco3_detune(-4.2f), // 3rd harmonic - slight flat for complex interference
+      mixer(nullptr),
+      attack_time(0.001f), decay_time(0.01f), sustain_level(0.8f), release_time(0.1f),
+      last_velocity(0.0f), sampler(nullptr),
       current_sample(0)
 {
+    memset(detune_mod, 0, sizeof(detune_mod));
+    memset(level_mod, 0, sizeof(level_mod));
+    memset(adsr_mod, 0, sizeof(adsr_mod));
+
+    if (!exp2_table_ready)
+    {
+        for (uint16_t i = 0; i <= EXP2_TABLE_SIZE; i++)
+        {
+            exp2_table[i] = pow(2.0f, (float)i / EXP2_TABLE_SIZE);
+        }
+        exp2_table_ready = true;
+    }
 }
 
 void Instrument::initializeComponents()
@@ -34,51 +56,55 @@ void Instrument::initializeComponents()
     stream2 = new audio_tools::GeneratedSoundStream<int16_t>(*vco2);
     stream3 = new audio_tools::GeneratedSoundStream<int16_t>(*vco3);
 
-    vco1->begin(info);
-    vco2->begin(info); // 2nd harmonic
-    vco3->begin(info); // 3rd harmonic
+    vco1->begin(osc_info);
+    vco2->begin(osc_info); // 2nd harmonic
+    vco3->begin(osc_info); // 3rd harmonic
 
     // Initialize all components
-    stream1->begin(info);
-    stream2->begin(info);
-    stream3->begin(info);
+    stream1->begin(osc_info);
+    stream2->begin(osc_info);
+    stream3->begin(osc_info);
 
     // Créer le mixer en tant que pointeur
-    mixer = new audio_tools::InputMixer<int16_t>();
+    mixer = new VCOMixer();
     mixer->add(*stream1, vco1_level * 100); // level for VCO1
     mixer->add(*stream2, vco2_level * 100); // level for VCO2
     mixer->add(*stream3, vco3_level * 100); // level for VCO3
-    mixer->begin(info);
-
-    adsr = new audio_tools::ADSRGain(
-        0.001f, // Attack très rapide (1ms)
-        0.01f,  // Decay rapide (10ms)
-        0.8f,   // Sustain élevé (80%)
-        0.05f   // Release rapide (100ms)
-    );
-
-    // Create ADSR with bowl-like envelope
-    // Long attack, moderate decay, high sustain, very long release
-  //  adsr->setActive(true);
-    effectStream = new audio_tools::AudioEffectStream(*mixer);
-    effectStream->addEffect(adsr);
-    effectStream->begin(info);
-
-    Serial.printf("🔍 Effects in stream: %d\n", effectStream->size());
-    Serial.printf("🔍 EffectStream pointer: %p\n", effectStream);
-    Serial.printf("🔍 ADSR pointer: %p\n", adsr);
-    Serial.printf("🔍 Mixer pointer: %p\n", mixer);
+    mixer->begin(osc_info);
+
+    // Enveloppe : attaque 1ms, decay 10ms, sustain 80%, release 100ms
+    envelope = new Envelope();
+    envelope->setInput(*mixer);
+    envelope->begin(osc_info);
+    applyADSR();
+
+    // Oversampled build: back to the output rate before the filter
+    audio_tools::AudioStream *voice_out = envelope;
+    if (AUDIO_OVERSAMPLING > 1)
+    {
+        decimator = new HalfBandDecimator();
+        decimator->setInput(*envelope);
+        decimator->begin(info);
+        voice_out = decimator;
+    }
+
+    // Filter pulls from the envelope stage, bypassed until a style enables it
+    filter = new SVFilter();
+    filter->setInput(*voice_out);
+    filter->begin(info);
+
+    LOG_PRINTF("🔍 Envelope pointer: %p\n", envelope);
+    LOG_PRINTF("🔍 Mixer pointer: %p\n", mixer);
 }
 
 Instrument::~Instrument()
 {
-    if (effectStream)
-    {
-        effectStream->end();
-        delete effectStream;
-    }
-    if (adsr)
-        delete adsr;
+    if (filter)
+        delete filter;
+    if (decimator)
+        delete decimator;
+    if (envelope)
+        delete envelope;
     if (mixer)
     {
         mixer->end();
@@ -110,18 +136,19 @@ Instrument::~Instrument()
 bool Instrument::begin(audio_tools::AudioInfo audioInfo)
 {
     info = audioInfo;
+    osc_info = oscillatorInfo(info);
 
-    Serial.println("TibetanBowl initialization...");
+    LOG_PRINTLN("TibetanBowl initialization...");
 
     initializeComponents();
 
-    if (!vco1 || !vco2 || !vco3 || !adsr || !mixer)
+    if (!vco1 || !vco2 || !vco3 || !envelope || !mixer || !filter)
     {
-        Serial.println("Error: Failed to initialize TibetanBowl components");
+        LOG_PRINTLN("Error: Failed to initialize TibetanBowl components");
         return false;
     }
 
-    Serial.println("TibetanBowl initialized successfully");
+    LOG_PRINTLN("TibetanBowl initialized successfully");
     return true;
 }
 
@@ -132,21 +159,67 @@ void Instrument::strike(float frequency, float velocity)
     // Update all VCO frequencies with harmonics and beating
     updateFrequencies();
 
+    // Layered sample starts with the VCOs
+    if (sampler)
+    {
+        sampler->trigger(velocity);
+    }
+
+    // Filter sweep restarts with the note
+    if (filter)
+    {
+        filter->trigger(velocity);
+    }
+
     // Trigger ADSR envelope
-    if (adsr)
+    last_velocity = velocity;
+    if (envelope)
     {
-        adsr->keyOn(velocity);
+        envelope->keyOn(velocity);
     }
 }
 
 void Instrument::release()
 {
-    if (adsr)
+    if (envelope)
+    {
+        envelope->keyOff();
+    }
+}
+
+void Instrument::setAccent(bool accented)
+{
+    if (filter)
+    {
+        filter->accentNext(accented);
+    }
+}
+
+void Instrument::setFilter(float cutoff, float resonance, float envOctaves, float decay)
+{
+    if (!filter)
+        return;
+
+    filter->setCutoff(cutoff);
+    filter->setResonance(resonance);
+    filter->setEnvelope(envOctaves, decay);
+}
+
+void Instrument::enableFilter(bool enable)
+{
+    if (filter)
     {
-        adsr->keyOff();
+        filter->setEnabled(enable);
     }
 }
 
+void Instrument::attachSampler(SamplePlayer *player)
+{
+    // Only the trigger: the sampler is a voice of its own, so it neither
+    // changes the VCO mix nor stops when this voice goes idle
+    sampler = player;
+}
+
 void Instrument::setVcoVolumes(float vco1, float vco2, float vco3)
 {
     vco1_level = vco1;
@@ -169,18 +242,105 @@ void Instrument::setBeating(float vco1_cents, float vco2_cents, float vco3_cents
 
 bool Instrument::isActive() const
 {
-    return adsr ? adsr->isActive() : false;
+    return envelope ? envelope->isActive() : false;
+}
+
+float Instrument::getEnvelopeLevel() const
+{
+    return envelope ? envelope->getLevel() : 0.0f;
+}
+
+Envelope::Stage Instrument::getEnvelopeStage() const
+{
+    return envelope ? envelope->getStage() : Envelope::IDLE;
 }
 
 void Instrument::setADSR(float attack, float decay, float sustain, float release)
 {
-    if (adsr)
+    attack_time = attack;
+    decay_time = decay;
+    sustain_level = sustain;
+    release_time = release;
+    applyADSR();
+}
+
+void Instrument::setDetuneModulation(float vco1_cents, float vco2_cents, float vco3_cents)
+{
+    // Skip the pow()/setFrequency() work when the modulation did not move
+    const float threshold = 0.1f; // cents
+    if (fabsf(vco1_cents - detune_mod[0]) < threshold &&
+        fabsf(vco2_cents - detune_mod[1]) < threshold &&
+        fabsf(vco3_cents - detune_mod[2]) < threshold)
+    {
+        return;
+    }
+
+    detune_mod[0] = vco1_cents;
+    detune_mod[1] = vco2_cents;
+    detune_mod[2] = vco3_cents;
+
+    if (fundamental_freq > 0)
+    {
+        updateFrequencies();
+    }
+}
+
+void Instrument::setLevelModulation(float vco1, float vco2, float vco3)
+{
+    const float threshold = 0.005f;
+    if (fabsf(vco1 - level_mod[0]) < threshold &&
+        fabsf(vco2 - level_mod[1]) < threshold &&
+        fabsf(vco3 - level_mod[2]) < threshold)
+    {
+        return;
+    }
+
+    level_mod[0] = vco1;
+    level_mod[1] = vco2;
+    level_mod[2] = vco3;
+    applyLevels();
+}
+
+void Instrument::setADSRModulation(float attack, float decay, float sustain, float release)
+{
+    // Pot jitter or an LFO would otherwise re-enter DECAY from SUSTAIN every block
+    const float threshold = 0.005f;
+    if (fabsf(attack - adsr_mod[0]) < threshold &&
+        fabsf(decay - adsr_mod[1]) < threshold &&
+        fabsf(sustain - adsr_mod[2]) < threshold &&
+        fabsf(release - adsr_mod[3]) < threshold)
     {
-        adsr->setAttackRate(attack);
-        adsr->setDecayRate(decay);
-        adsr->setSustainLevel(sustain);
-        adsr->setReleaseRate(release);
+        return;
     }
+
+    adsr_mod[0] = attack;
+    adsr_mod[1] = decay;
+    adsr_mod[2] = sustain;
+    adsr_mod[3] = release;
+    applyADSR();
+}
+
+void Instrument::applyLevels()
+{
+    if (!mixer)
+        return;
+
+    // Mixer weights are percentages, as in initializeComponents()
+    mixer->setWeight(0, constrain(vco1_level + level_mod[0], 0.0f, 1.0f) * 100);
+    mixer->setWeight(1, constrain(vco2_level + level_mod[1], 0.0f, 1.0f) * 100);
+    mixer->setWeight(2, constrain(vco3_level + level_mod[2], 0.0f, 1.0f) * 100);
+}
+
+void Instrument::applyADSR()
+{
+    if (!envelope)
+        return;
+
+    // Time modulation is in octaves x4: +0.25 doubles a time, -0.25 halves it
+    envelope->setADSR(attack_time * exp2f(4.0f * adsr_mod[0]),
+                      decay_time * exp2f(4.0f * adsr_mod[1]),
+                      constrain(sustain_level + adsr_mod[2], 0.0f, 1.0f),
+                      release_time * exp2f(4.0f * adsr_mod[3]));
 }
 
 void Instrument::updateFrequencies()
@@ -189,37 +349,48 @@ void Instrument::updateFrequencies()
         return;
 
     // VCO1: Fundamental frequency
-    float freq1 = fundamental_freq * 1.0f * centsToRatio(vco1_detune);
+    float freq1 = fundamental_freq * 1.0f * centsToRatio(vco1_detune + detune_mod[0]);
 
     // VCO2: 2nd harmonic with slight detuning for beating
-    float freq2 = fundamental_freq * 2.0f * centsToRatio(vco2_detune);
+    float freq2 = fundamental_freq * 2.0f * centsToRatio(vco2_detune + detune_mod[1]);
 
     // VCO3: 3rd harmonic with slight detuning for beating
-    float freq3 = fundamental_freq * 3.0f * centsToRatio(vco3_detune);
+    float freq3 = fundamental_freq * 3.0f * centsToRatio(vco3_detune + detune_mod[2]);
 
     // Update VCO frequencies
     vco1->setFrequency(freq1);
     vco2->setFrequency(freq2);
     vco3->setFrequency(freq3);
 
-    // Serial.printf("🎶 Frequencies: %.2f Hz\n", fundamental_freq);
+    // LOG_PRINTF("🎶 Frequencies: %.2f Hz\n", fundamental_freq);
 }
 
 float Instrument::centsToRatio(float cents)
 {
     // Convert cents to frequency ratio
     // 100 cents = 1 semitone = ratio of 2^(1/12)
-    return pow(2.0f, cents / 1200.0f);
+    // Table lookup + linear interpolation: cheap enough for per-block LFO modulation
+    float octaves = cents / 1200.0f;
+    int whole = (int)floorf(octaves);
+    float pos = (octaves - whole) * EXP2_TABLE_SIZE;
+    uint16_t index = (uint16_t)pos;
+    if (index >= EXP2_TABLE_SIZE)
+    {
+        index = EXP2_TABLE_SIZE - 1;
+    }
+    float frac = pos - index;
+    float ratio = exp2_table[index] + (exp2_table[index + 1] - exp2_table[index]) * frac;
+    return ldexpf(ratio, whole);
 }
 
 
 void Instrument::setupVCOs(const String &style)
 {
-    Serial.printf("🎛️ Setting up VCOs for style: %s\n", style.c_str());
+    LOG_PRINTF("🎛️ Setting up VCOs for style: %s\n", style.c_str());
     if (style == "tibetan")
     {
         // TIBETAN BOWL Configuration traditionnelle
-        Serial.println("🎎 Configuring TIBETAN BOWL preset");
+        LOG_PRINTLN("🎎 Configuring TIBETAN BOWL preset");
 
         vco1_detune = 0.0f;  // Fondamentale pure
         vco2_detune = 5.0f;  // 2ème harmonique légèrement sharp
@@ -229,26 +400,24 @@ void Instrument::setupVCOs(const String &style)
         vco2_level = 0.6f; // Harmoniques naturelles
         vco3_level = 0.3f; // Harmoniques subtiles
 
-        if (adsr)
+        // Frappe nette, longue résonance qui s'éteint exponentiellement
+        attack_time = 0.005f;  // 5ms
+        decay_time = 2.0f;     // -60 dB vers le sustain en 2s
+        sustain_level = 0.6f;
+        release_time = 8.0f;   // 8s de queue
+        if (envelope)
         {
-
-            adsr->setAttackRate(1.0f);
-            adsr->setDecayRate(1.0f);
-            adsr->setSustainLevel(1.0f);
-            adsr->setReleaseRate(1.0f);
-
-            //  adsr->setAttackRate(0.005f);
-            // adsr->setDecayRate(0.005f);
-            // adsr->setSustainLevel(0.005f);
-            // adsr->setReleaseRate(0.005f);
+            envelope->setShapes(Envelope::LINEAR, Envelope::EXPONENTIAL);
         }
 
-        Serial.println("✅ TIBETAN setup complete - Traditional bowl resonance!");
+        enableFilter(false);
+
+        LOG_PRINTLN("✅ TIBETAN setup complete - Traditional bowl resonance!");
     }
     else if (style == "acid")
     {
         // ACID TECHNO AMBIENT Configuration
-        Serial.println("🔊 Configuring ACID TECHNO AMBIENT preset");
+        LOG_PRINTLN("🔊 Configuring ACID TECHNO AMBIENT preset");
 
         // === FRÉQUENCES ET DÉTUNE ===
         vco1_detune = 0.0f;  // Fondamentale stable
@@ -261,20 +430,32 @@ void Instrument::setupVCOs(const String &style)
         vco3_level = 0.45f; // Harmoniques subtiles (45%)
 
         // === CONFIGURATION ADSR ACID ===
-        if (adsr)
+        attack_time = 0.002f;  // Attaque très rapide (2ms) - punch acid
+        decay_time = 0.08f;    // Decay modéré (80ms) - caractère acid
+        sustain_level = 0.6f;  // Sustain à 60% - maintien du groove
+        release_time = 0.15f;  // Release plus long (150ms) - queue ambient
+        if (envelope)
         {
-            adsr->setAttackRate(0.002f); // Attaque très rapide (2ms) - punch acid
-            adsr->setDecayRate(0.08f);   // Decay modéré (80ms) - caractère acid
-            adsr->setSustainLevel(0.6f); // Sustain à 60% - maintien du groove
-            adsr->setReleaseRate(0.15f); // Release plus long (150ms) - queue ambient
+            envelope->setShapes(Envelope::LINEAR, Envelope::EXPONENTIAL);
         }
 
-        Serial.println("✅ ACID setup complete - Ready for squelchy basslines!");
+        // === FILTRE 303 ===
+        // Cutoff bas, résonance haute, l'enveloppe ouvre de 3 octaves ;
+        // les accents ajoutent 1.5 octave avec un decay plus court
+        setFilter(250.0f, 0.85f, 3.0f, 0.35f);
+        if (filter)
+        {
+            filter->setMode(SVFilter::LOWPASS);
+            filter->setAccent(1.5f, 0.12f);
+        }
+        enableFilter(true);
+
+        LOG_PRINTLN("✅ ACID setup complete - Ready for squelchy basslines!");
     }
     else if (style == "ambient")
     {
         // AMBIENT Configuration douce et atmosphérique
-        Serial.println("🌊 Configuring AMBIENT preset");
+        LOG_PRINTLN("🌊 Configuring AMBIENT preset");
 
         vco1_detune = 0.0f;  // Fondamentale pure
         vco2_detune = 3.8f;  // Détune subtil pour richesse
@@ -284,36 +465,42 @@ void Instrument::setupVCOs(const String &style)
         vco2_level = 0.4f; // Doux
         vco3_level = 0.6f; // Harmoniques proéminentes
 
-        if (adsr)
+        attack_time = 2.5f;    // Ultra-lent (montée RC)
+        decay_time = 3.0f;     // Très doux
+        sustain_level = 0.85f; // Sustain élevé
+        release_time = 12.0f;  // Release quasi infini
+        if (envelope)
         {
-            adsr->setAttackRate(1.0f);    // Ultra-lent
-            adsr->setDecayRate(0.08f);    // Très doux
-            adsr->setSustainLevel(0.85f); // Sustain élevé
-            adsr->setReleaseRate(0.01f);  // Release infini
+            envelope->setShapes(Envelope::EXPONENTIAL, Envelope::EXPONENTIAL);
         }
 
-        Serial.println("✅ AMBIENT setup complete - Ethereal soundscapes ready!");
+        enableFilter(false);
+
+        LOG_PRINTLN("✅ AMBIENT setup complete - Ethereal soundscapes ready!");
     }
 
     else
     {
-        Serial.printf("⚠️ Unknown style: %s. Using default tibetan configuration.\n", style.c_str());
+        LOG_PRINTF("⚠️ Unknown style: %s. Using default tibetan configuration.\n", style.c_str());
         setupVCOs("tibetan"); // Fallback vers configuration par défaut
         return;
     }
 
+    applyADSR();
+
     // === RECONFIGURATION COMPLÈTE DU MIXER ===
-    Serial.println("🔄 Reconfiguring mixer with new levels...");
+    LOG_PRINTLN("🔄 Reconfiguring mixer with new levels...");
     if (stream1 && stream2 && stream3)
     {
         mixer->end(); // Arrêter le mixer existant
         mixer->add(*stream1, vco1_level * 100);
         mixer->add(*stream2, vco2_level * 100);
         mixer->add(*stream3, vco3_level * 100);
-        mixer->begin(info);
+        mixer->begin(osc_info);
+        applyLevels();
 
-        Serial.printf("🎚️ Mixer reconfigured - VCO1: %.1f%%, VCO2: %.1f%%, VCO3: %.1f%%\n",
-                      vco1_level * 100, vco2_level * 100, vco3_level * 100);
+        LOG_PRINTF("🎚️ Mixer reconfigured - VCO1: %.1f%%, VCO2: %.1f%%, VCO3: %.1f%%\n",
+                   vco1_level * 100, vco2_level * 100, vco3_level * 100);
     }
 
 
@@ -323,26 +510,24 @@ void Instrument::setupVCOs(const String &style)
     if (fundamental_freq > 0)
     {
         updateFrequencies();
-        //  Serial.printf("🎵 Frequencies updated for %s style\n", style.c_str());
+        //  LOG_PRINTF("🎵 Frequencies updated for %s style\n", style.c_str());
     }
 
-    Serial.printf("🎛️ VCO Setup complete - Style: %s\n", style.c_str());
-    Serial.printf("   VCO1: %.1f%% (detune: %.1f cents)\n", vco1_level * 100, vco1_detune);
-    Serial.printf("   VCO2: %.1f%% (detune: %.1f cents)\n", vco2_level * 100, vco2_detune);
-    Serial.printf("   VCO3: %.1f%% (detune: %.1f cents)\n", vco3_level * 100, vco3_detune);
+    LOG_PRINTF("🎛️ VCO Setup complete - Style: %s\n", style.c_str());
+    LOG_PRINTF("   VCO1: %.1f%% (detune: %.1f cents)\n", vco1_level * 100, vco1_detune);
+    LOG_PRINTF("   VCO2: %.1f%% (detune: %.1f cents)\n", vco2_level * 100, vco2_detune);
+    LOG_PRINTF("   VCO3: %.1f%% (detune: %.1f cents)\n", vco3_level * 100, vco3_detune);
 }
 
 // Méthode utilitaire pour changer de style à la volée
 void Instrument::morphToStyle(const String &targetStyle, float morphTime)
 {
     // TODO: Implémentation future pour transition graduelle entre styles
-    Serial.printf("🌀 Morphing to %s (instant for now)\n", targetStyle.c_str());
+    LOG_PRINTF("🌀 Morphing to %s (instant for now)\n", targetStyle.c_str());
     setupVCOs(targetStyle);
 }
 
 audio_tools::AudioStream *Instrument::getAudioStream()
 {
-    Serial.printf("🎯 Returning mixer: %p\n", mixer);
-    // return &mixer;
-    return effectStream;
+    return filter ? (audio_tools::AudioStream *)filter : (audio_tools::AudioStream *)envelope;
 }
@@ -3,8 +3,16 @@
 
 #include <Arduino.h>
 #include <AudioTools.h>
-
-class Instrument
+#include <AudioConfig.h>
+#include <AsyncLog.h>
+#include <SamplePlayer.h>
+#include <SVFilter.h>
+#include <HalfBandDecimator.h>
+#include <Envelope.h>
+#include <VCOMixer.h>
+#include <Voice.h>
+
+class Instrument : public Voice
 {
 private:
     // Three VCOs for harmonic content
@@ -17,12 +25,17 @@ private:
     audio_tools::GeneratedSoundStream<int16_t> *stream2;
     audio_tools::GeneratedSoundStream<int16_t> *stream3;
 
-    // ADSR envelope
-    audio_tools::ADSRGain *adsr;
+    // ADSR envelope, pulls from the mixer
+    Envelope *envelope;
 
-    // Audio configuration
+    // Audio configuration: the VCOs, mixer and envelope run at osc_info,
+    // twice the output rate in oversampled builds
     audio_tools::AudioInfo info;
-    audio_tools::AudioEffectStream* effectStream;
+    audio_tools::AudioInfo osc_info;
+    HalfBandDecimator *decimator;
+
+    // Resonant filter after the envelope (acid style)
+    SVFilter *filter;
 
     // Bowl parameters
     float fundamental_freq;
@@ -34,7 +47,22 @@ private:
     float vco1_detune;
     float vco2_detune; // Cents detuning for beating effect
     float vco3_detune;
-    InputMixer<int16_t> *mixer;
+    VCOMixer *mixer;
+
+    // ADSR base settings in seconds (modulation is applied on top)
+    float attack_time;
+    float decay_time;
+    float sustain_level;
+    float release_time;
+
+    // Control-rate modulation offsets (see ModMatrix)
+    float detune_mod[3];
+    float level_mod[3];
+    float adsr_mod[4];
+    float last_velocity;
+
+    // Optional sample layer, triggered with the VCOs (mixed by RenderStream)
+    SamplePlayer *sampler;
 
     // Current mixed sample
     int16_t current_sample;
@@ -47,29 +75,47 @@ public:
     bool begin(audio_tools::AudioInfo audioInfo);
 
     // Bowl control
-    void strike(float frequency = 440.0f, float velocity = 1.0f);
-    void release();
+    void strike(float frequency = 440.0f, float velocity = 1.0f) override;
+    void release() override;
+    void setAccent(bool accented) override;
 
     // Get mixed audio sample
     int16_t readSample();
 
 
 
-    // Configuration
+    // Configuration (times in seconds)
     void setADSR(float attack = 0.1f, float decay = 0.2f, float sustain = 0.7f, float release = 8.0f);
     void setVcoVolumes(float vco1 = 1.0f, float vco2 = 0.6f, float vco3 = 0.3f);
     void setBeating(float vco1_cents = 3.0f, float vco2_cents = 3.0f, float vco3_cents = -2.5f);
    // audio_tools::InputMixer<int16_t>* getAudioStream();
-    audio_tools::AudioStream* getAudioStream();
+    audio_tools::AudioStream* getAudioStream() override;
+
+    // Filter: cutoff in Hz, resonance 0-1, envelope sweep in octaves
+    void setFilter(float cutoff, float resonance, float envOctaves, float decay);
+    void enableFilter(bool enable);
+    SVFilter *getFilter() { return filter; }
+
+    // Sample layer: triggered with every strike
+    void attachSampler(SamplePlayer *player);
+
+    // Control-rate modulation, called once per audio block
+    void setDetuneModulation(float vco1_cents, float vco2_cents, float vco3_cents);
+    void setLevelModulation(float vco1, float vco2, float vco3);
+    void setADSRModulation(float attack, float decay, float sustain, float release);
 
     // Status
-    bool isActive() const;
+    bool isActive() const override;
+    float getEnvelopeLevel() const;
+    Envelope::Stage getEnvelopeStage() const;
     void setupVCOs(const String& style);
     void morphToStyle(const String& targetStyle, float morphTime = 1.0f);
 
 private:
     void initializeComponents();
     void updateFrequencies();
+    void applyLevels();
+    void applyADSR();
     float centsToRatio(float cents);
 };
 
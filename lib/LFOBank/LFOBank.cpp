@@ -0,0 +1,99 @@
+#include <LFOBank.h>
+
+float LFOBank::sine_table[LFOBank::SINE_TABLE_SIZE];
+bool LFOBank::table_ready = false;
+
+LFOBank::LFOBank()
+    : noise_state(0x12345678)
+{
+    buildTable();
+
+    for (uint8_t i = 0; i < NUM_LFOS; i++)
+    {
+        lfos[i].shape = SINE;
+        lfos[i].rate = 0.1f;
+        lfos[i].phase = 0.0f;
+        lfos[i].value = 0.0f;
+    }
+}
+
+void LFOBank::buildTable()
+{
+    if (table_ready)
+    {
+        return;
+    }
+
+    for (uint16_t i = 0; i < SINE_TABLE_SIZE; i++)
+    {
+        sine_table[i] = sinf(TWO_PI * i / SINE_TABLE_SIZE);
+    }
+    table_ready = true;
+}
+
+void LFOBank::setShape(uint8_t index, Shape shape)
+{
+    if (index < NUM_LFOS)
+    {
+        lfos[index].shape = shape;
+    }
+}
+
+void LFOBank::setRate(uint8_t index, float rate_hz)
+{
+    if (index < NUM_LFOS)
+    {
+        lfos[index].rate = constrain(rate_hz, 0.0f, 50.0f);
+    }
+}
+
+void LFOBank::setPhase(uint8_t index, float phase)
+{
+    if (index < NUM_LFOS)
+    {
+        lfos[index].phase = phase - floorf(phase);
+    }
+}
+
+void LFOBank::update(float dt)
+{
+    for (uint8_t i = 0; i < NUM_LFOS; i++)
+    {
+        LFO &lfo = lfos[i];
+
+        lfo.phase += lfo.rate * dt;
+        bool wrapped = lfo.phase >= 1.0f;
+        if (wrapped)
+        {
+            lfo.phase -= floorf(lfo.phase);
+        }
+
+        switch (lfo.shape)
+        {
+        case SINE:
+            lfo.value = sine_table[(uint16_t)(lfo.phase * SINE_TABLE_SIZE) % SINE_TABLE_SIZE];
+            break;
+
+        case TRIANGLE:
+            lfo.value = lfo.phase < 0.5f ? 4.0f * lfo.phase - 1.0f : 3.0f - 4.0f * lfo.phase;
+            break;
+
+        case SAMPLE_HOLD:
+            // New value once per cycle
+            if (wrapped)
+            {
+                lfo.value = nextRandom();
+            }
+            break;
+        }
+    }
+}
+
+float LFOBank::nextRandom()
+{
+    // xorshift32: keeps the Arduino random() sequence used by patterns untouched
+    noise_state ^= noise_state << 13;
+    noise_state ^= noise_state >> 17;
+    noise_state ^= noise_state << 5;
+    return (noise_state / 2147483648.0f) - 1.0f;
+}
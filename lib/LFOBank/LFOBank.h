@@ -0,0 +1,55 @@
+#ifndef LFOBANK_H
+#define LFOBANK_H
+
+#include "Arduino.h"
+
+// Small bank of control-rate LFOs, advanced once per audio block.
+// Outputs are bipolar (-1..1) and feed the ModMatrix LFO sources.
+class LFOBank
+{
+public:
+    static const uint8_t NUM_LFOS = 4;
+
+    enum Shape : uint8_t
+    {
+        SINE,
+        TRIANGLE,
+        SAMPLE_HOLD
+    };
+
+private:
+    struct LFO
+    {
+        Shape shape;
+        float rate;  // Hz
+        float phase; // 0..1
+        float value; // -1..1
+    };
+
+    LFO lfos[NUM_LFOS];
+    uint32_t noise_state;
+
+    // 256 points are plenty at control rate
+    static const uint16_t SINE_TABLE_SIZE = 256;
+    static float sine_table[SINE_TABLE_SIZE];
+    static bool table_ready;
+
+public:
+    LFOBank();
+
+    // Configuration
+    void setShape(uint8_t index, Shape shape);
+    void setRate(uint8_t index, float rate_hz);
+    void setPhase(uint8_t index, float phase);
+
+    // Advance every LFO by dt seconds (one audio block)
+    void update(float dt);
+
+    float get(uint8_t index) const { return index < NUM_LFOS ? lfos[index].value : 0.0f; }
+
+private:
+    float nextRandom();
+    static void buildTable();
+};
+
+#endif // LFOBANK_H
@@ -0,0 +1,121 @@
+#include <MasterBus.h>
+
+MasterBus::MasterBus()
+    : drive_q10(1024), meter_lock(portMUX_INITIALIZER_UNLOCKED),
+      peak(0), sum_squares(0), limited(0), clipped(0), samples(0)
+{
+    memset(curve, 0, sizeof(curve));
+}
+
+void MasterBus::begin()
+{
+    buildCurve();
+}
+
+void MasterBus::buildCurve()
+{
+    // Above the knee: y = knee + headroom * tanh((x - knee) / headroom),
+    // slope 1 at the knee so the join is inaudible
+    const float headroom = FULL_SCALE - KNEE;
+    for (uint16_t i = 0; i <= CURVE_SIZE; i++)
+    {
+        float over = (float)((int32_t)i << CURVE_SHIFT);
+        curve[i] = (int16_t)(KNEE + headroom * tanhf(over / headroom));
+    }
+}
+
+void MasterBus::setDrive(float db)
+{
+    db = constrain(db, -12.0f, 12.0f);
+    drive_q10 = (int32_t)(1024.0f * powf(10.0f, db / 20.0f));
+}
+
+void MasterBus::process(const int32_t *in, int16_t *out, uint32_t count)
+{
+    int32_t drive = drive_q10;
+    int32_t block_peak = 0;
+    uint64_t block_squares = 0;
+    uint32_t block_limited = 0;
+    uint32_t block_clipped = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        int32_t x = constrain(in[i], -MAX_INPUT, MAX_INPUT);
+        x = (x * drive) >> 10;
+
+        int32_t magnitude = x < 0 ? -x : x;
+        if (magnitude > block_peak)
+        {
+            block_peak = magnitude;
+        }
+
+        int32_t y = magnitude;
+        if (magnitude > KNEE)
+        {
+            block_limited++;
+            if (magnitude > FULL_SCALE)
+            {
+                block_clipped++;
+            }
+
+            // Table lookup with linear interpolation, integer only
+            uint32_t over = magnitude - KNEE;
+            uint32_t index = over >> CURVE_SHIFT;
+            if (index >= CURVE_SIZE)
+            {
+                y = curve[CURVE_SIZE];
+            }
+            else
+            {
+                int32_t frac = over & ((1 << CURVE_SHIFT) - 1);
+                y = curve[index] + (((curve[index + 1] - curve[index]) * frac) >> CURVE_SHIFT);
+            }
+        }
+
+        int16_t sample = (int16_t)(x < 0 ? -y : y);
+        out[i] = sample;
+        block_squares += (int32_t)sample * sample;
+    }
+
+    // Merged once per block, the lock is held for a few instructions
+    portENTER_CRITICAL(&meter_lock);
+    if (block_peak > peak)
+    {
+        peak = block_peak;
+    }
+    sum_squares += block_squares;
+    limited += block_limited;
+    clipped += block_clipped;
+    samples += count;
+    portEXIT_CRITICAL(&meter_lock);
+}
+
+void MasterBus::addSilence(uint32_t count)
+{
+    portENTER_CRITICAL(&meter_lock);
+    samples += count;
+    portEXIT_CRITICAL(&meter_lock);
+}
+
+MasterBus::Meter MasterBus::readMeter()
+{
+    portENTER_CRITICAL(&meter_lock);
+    int32_t window_peak = peak;
+    uint64_t window_squares = sum_squares;
+    Meter meter;
+    meter.limited = limited;
+    meter.clipped = clipped;
+    meter.samples = samples;
+    peak = 0;
+    sum_squares = 0;
+    limited = 0;
+    clipped = 0;
+    samples = 0;
+    portEXIT_CRITICAL(&meter_lock);
+
+    // Silence reads as -96 dBFS, the 16-bit floor
+    float rms = meter.samples ? sqrtf((float)window_squares / meter.samples) : 0.0f;
+    meter.peak_db = window_peak > 0 ? 20.0f * log10f(window_peak / (float)FULL_SCALE) : -96.0f;
+    meter.rms_db = rms > 0.5f ? 20.0f * log10f(rms / FULL_SCALE) : -96.0f;
+    return meter;
+}
@@ -0,0 +1,65 @@
+#ifndef MASTERBUS_H
+#define MASTERBUS_H
+
+#include "Arduino.h"
+
+// Last stage before the DAC: 32-bit bus in, 16-bit samples out.
+//
+// The bus is scaled by the master drive, then passes through a soft
+// clipper: linear up to the knee (-6 dBFS), then a tanh curve read from a
+// table that reaches full scale smoothly instead of wrapping or clipping
+// hard. Peak (before the clipper, so it can read above 0 dBFS) and RMS
+// (after it) are gathered on the audio side and read from loop().
+class MasterBus
+{
+public:
+    static const int32_t FULL_SCALE = 32767;
+    static const int32_t KNEE = 16384;          // -6 dBFS
+    static const uint16_t CURVE_SIZE = 512;
+    static const uint8_t CURVE_SHIFT = 8;       // curve covers KNEE .. KNEE + 512 << 8 (+12 dB)
+    static const int32_t MAX_INPUT = 500000;    // keeps input * drive inside 32 bits
+
+    struct Meter
+    {
+        float peak_db;     // dBFS before the clipper
+        float rms_db;      // dBFS at the output
+        uint32_t limited;  // samples that went through the curve
+        uint32_t clipped;  // samples that would have clipped without it
+        uint32_t samples;
+    };
+
+private:
+    int16_t curve[CURVE_SIZE + 1];
+    volatile int32_t drive_q10; // 1024 = 0 dB
+
+    // Accumulated since the last readMeter()
+    mutable portMUX_TYPE meter_lock;
+    int32_t peak;
+    uint64_t sum_squares;
+    uint32_t limited;
+    uint32_t clipped;
+    uint32_t samples;
+
+public:
+    MasterBus();
+
+    void begin();
+
+    // -12 .. +12 dB before the clipper
+    void setDrive(float db);
+    float getDrive() const { return 20.0f * log10f(drive_q10 / 1024.0f); }
+
+    // Audio task: scales, soft-clips and meters one block
+    void process(const int32_t *in, int16_t *out, uint32_t count);
+
+    // Audio task: count samples the render skipped as silent
+    void addSilence(uint32_t count);
+
+    // Control side: meter values since the previous call, then resets them
+    Meter readMeter();
+
+private:
+    void buildCurve();
+};
+
+#endif // MASTERBUS_H
@@ -0,0 +1,92 @@
+#include <ModMatrix.h>
+
+ModMatrix::ModMatrix()
+    : num_routes(0)
+{
+    memset(routes, 0, sizeof(routes));
+    memset(sources, 0, sizeof(sources));
+    memset(outputs, 0, sizeof(outputs));
+}
+
+int8_t ModMatrix::addRoute(uint8_t source, uint8_t destination, float depth)
+{
+    if (num_routes >= MAX_ROUTES || source >= SRC_COUNT || destination >= DST_COUNT)
+    {
+        return -1;
+    }
+
+    routes[num_routes].source = source;
+    routes[num_routes].destination = destination;
+    routes[num_routes].depth = depth;
+    return num_routes++;
+}
+
+void ModMatrix::setDepth(uint8_t route_index, float depth)
+{
+    if (route_index < num_routes)
+    {
+        routes[route_index].depth = depth;
+    }
+}
+
+void ModMatrix::removeRoute(uint8_t route_index)
+{
+    if (route_index >= num_routes)
+    {
+        return;
+    }
+
+    // Keep the table compact so process() never walks holes
+    for (uint8_t i = route_index; i + 1 < num_routes; i++)
+    {
+        routes[i] = routes[i + 1];
+    }
+    num_routes--;
+}
+
+void ModMatrix::clear()
+{
+    num_routes = 0;
+    memset(outputs, 0, sizeof(outputs));
+}
+
+void ModMatrix::setSource(uint8_t source, float value)
+{
+    if (source < SRC_COUNT)
+    {
+        sources[source] = value;
+    }
+}
+
+void ModMatrix::process()
+{
+    memset(outputs, 0, sizeof(outputs));
+
+    // At most MAX_ROUTES multiply-adds per block
+    for (uint8_t i = 0; i < num_routes; i++)
+    {
+        const Route &route = routes[i];
+        outputs[route.destination] += route.depth * sources[route.source];
+    }
+}
+
+ModMatrix::Route ModMatrix::getRoute(uint8_t route_index) const
+{
+    if (route_index < num_routes)
+    {
+        return routes[route_index];
+    }
+    Route empty = {0, 0, 0.0f};
+    return empty;
+}
+
+void ModMatrix::printRoutes() const
+{
+    Serial.println("=== MOD MATRIX ===");
+    for (uint8_t i = 0; i < num_routes; i++)
+    {
+        Serial.printf("Route %2d: src %2d -> dst %2d | depth %.3f\n",
+                      i, routes[i].source, routes[i].destination, routes[i].depth);
+    }
+    Serial.println();
+}
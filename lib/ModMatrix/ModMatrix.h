@@ -0,0 +1,83 @@
+#ifndef MODMATRIX_H
+#define MODMATRIX_H
+
+#include "Arduino.h"
+
+// Control-rate modulation matrix: a flat table of source -> destination -> depth
+// routes, summed once per audio block into one offset per destination.
+class ModMatrix
+{
+public:
+    static const uint8_t MAX_ROUTES = 32;
+    static const uint8_t NUM_MUX_CHANNELS = 32; // 2 x 74HCT4067, 16 channels each
+    static const uint8_t NUM_LFOS = 4;
+
+    enum Source : uint8_t
+    {
+        SRC_MUX_FIRST = 0, // MUX0 ch0..15 then MUX1 ch0..15, normalized 0..1
+        SRC_MUX_LAST = SRC_MUX_FIRST + NUM_MUX_CHANNELS - 1,
+        SRC_ENVELOPE,      // Envelope level 0..1
+        SRC_LFO1,          // LFOs are bipolar -1..1
+        SRC_LFO2,
+        SRC_LFO3,
+        SRC_LFO4,
+        SRC_COUNT
+    };
+
+    enum Destination : uint8_t
+    {
+        DST_VCO1_DETUNE = 0, // cents
+        DST_VCO2_DETUNE,
+        DST_VCO3_DETUNE,
+        DST_VCO1_LEVEL,      // level offset (1.0 = 100%)
+        DST_VCO2_LEVEL,
+        DST_VCO3_LEVEL,
+        DST_ATTACK,          // ADSR times (x4 octaves) / sustain level offset
+        DST_DECAY,
+        DST_SUSTAIN,
+        DST_RELEASE,
+        DST_GATE_LENGTH,     // gate scale offset (0 = unchanged)
+        DST_TEMPO,           // tempo scale offset (0 = unchanged)
+        DST_COUNT
+    };
+
+    struct Route
+    {
+        uint8_t source;
+        uint8_t destination;
+        float depth;
+    };
+
+private:
+    Route routes[MAX_ROUTES];
+    uint8_t num_routes;
+
+    float sources[SRC_COUNT];
+    float outputs[DST_COUNT];
+
+public:
+    ModMatrix();
+
+    // Routing
+    int8_t addRoute(uint8_t source, uint8_t destination, float depth);
+    void setDepth(uint8_t route_index, float depth);
+    void removeRoute(uint8_t route_index);
+    void clear();
+
+    // Sources are written by the owner before process()
+    void setSource(uint8_t source, float value);
+    float getSource(uint8_t source) const { return source < SRC_COUNT ? sources[source] : 0.0f; }
+    static uint8_t muxSource(uint8_t muxIndex, uint8_t channelIndex) { return SRC_MUX_FIRST + muxIndex * 16 + channelIndex; }
+
+    // Evaluate every route once (call once per audio block)
+    void process();
+    float get(uint8_t destination) const { return destination < DST_COUNT ? outputs[destination] : 0.0f; }
+
+    uint8_t getNumRoutes() const { return num_routes; }
+    Route getRoute(uint8_t route_index) const;
+
+    // Debug
+    void printRoutes() const;
+};
+
+#endif // MODMATRIX_H
@@ -0,0 +1,237 @@
+#include <ModalBowl.h>
+
+// Partials of a hand-hammered bowl, relative to the fundamental, and their
+// strike amplitudes: inharmonic, each one weaker than the one below
+static const float bowl_ratios[ModalBowl::NUM_PARTIALS] = {1.0f, 2.77f, 5.18f, 8.19f, 11.8f, 16.0f, 20.7f, 26.0f};
+static const float bowl_weights[ModalBowl::NUM_PARTIALS] = {1.0f, 0.7f, 0.45f, 0.3f, 0.2f, 0.13f, 0.08f, 0.05f};
+
+// ln(1000): a T60 is a 60 dB decay
+static const float LN_1000 = 6.9078f;
+
+ModalBowl::ModalBowl()
+    : info(defaultAudioInfo()), num_modes(0), pending_modes(8), pending_retune(false), fundamental(220.0f),
+      decay_seconds(12.0f), release_seconds(3.0f), split_cents(3.0f), output_gain(0),
+      released(false), ringing(false)
+{
+    memset(ratio, 0, sizeof(ratio));
+    memset(weight, 0, sizeof(weight));
+    memset(cos_w, 0, sizeof(cos_w));
+    memset(sin_w, 0, sizeof(sin_w));
+    memset(radius, 0, sizeof(radius));
+    memset(a1, 0, sizeof(a1));
+    memset(a2, 0, sizeof(a2));
+    memset(y1, 0, sizeof(y1));
+    memset(y2, 0, sizeof(y2));
+}
+
+bool ModalBowl::begin(audio_tools::AudioInfo audioInfo)
+{
+    info = audioInfo;
+    if (info.bits_per_sample != 16)
+    {
+        LOG_PRINTLN("Error: ModalBowl supports 16-bit output only");
+        return false;
+    }
+    configureModes(pending_modes);
+    return true;
+}
+
+void ModalBowl::setModes(uint8_t count)
+{
+    pending_modes = count > 8 ? 16 : 8;
+}
+
+void ModalBowl::setDecay(float seconds)
+{
+    decay_seconds = constrain(seconds, 0.2f, 60.0f);
+    updateDamping();
+}
+
+void ModalBowl::setRelease(float seconds)
+{
+    release_seconds = constrain(seconds, 0.05f, 30.0f);
+    if (released)
+    {
+        updateDamping();
+    }
+}
+
+void ModalBowl::setSplit(float cents)
+{
+    split_cents = constrain(cents, 0.0f, 50.0f);
+    pending_retune = true;
+}
+
+void ModalBowl::configureModes(uint8_t count)
+{
+    // 8 modes: one per partial. 16 modes: each partial as a split doublet
+    bool doublets = count == 16;
+    float split = powf(2.0f, split_cents / 1200.0f);
+    float total_weight = 0;
+
+    for (uint8_t m = 0; m < count; m++)
+    {
+        uint8_t partial = doublets ? m / 2 : m;
+        bool upper = doublets && (m & 1);
+        ratio[m] = bowl_ratios[partial] * (upper ? split : 1.0f);
+        weight[m] = bowl_weights[partial] * (doublets ? 0.5f : 1.0f);
+        total_weight += weight[m];
+    }
+
+    num_modes = count;
+    output_gain = 16000.0f / total_weight;
+    tune();
+}
+
+void ModalBowl::tune()
+{
+    float w0 = TWO_PI * fundamental / info.sample_rate;
+    for (uint8_t m = 0; m < num_modes; m++)
+    {
+        float w = w0 * ratio[m];
+        if (w < 0.45f * TWO_PI)
+        {
+            cos_w[m] = cosf(w);
+            sin_w[m] = sinf(w);
+        }
+        else
+        {
+            // Above Nyquist: silent
+            cos_w[m] = 0;
+            sin_w[m] = 0;
+        }
+    }
+    updateDamping();
+}
+
+void ModalBowl::updateDamping()
+{
+    for (uint8_t m = 0; m < num_modes; m++)
+    {
+        // Upper partials ring shorter, a hand on the rim shortens them all
+        float t60 = decay_seconds / powf(ratio[m], 0.7f);
+        if (released)
+        {
+            t60 = min(t60, release_seconds);
+        }
+
+        radius[m] = sin_w[m] != 0 ? expf(-LN_1000 / (t60 * info.sample_rate)) : 0.0f;
+        a1[m] = 2.0f * radius[m] * cos_w[m];
+        a2[m] = radius[m] * radius[m];
+    }
+}
+
+void ModalBowl::strike(float frequency, float velocity)
+{
+    velocity = constrain(velocity, 0.0f, 1.0f);
+
+    if (fabsf(frequency - fundamental) > 0.01f)
+    {
+        fundamental = frequency;
+        tune();
+    }
+    if (released)
+    {
+        released = false;
+        updateDamping();
+    }
+
+    // Impulse into every resonator, on top of what is still ringing.
+    // Softer strikes excite the upper partials even less.
+    for (uint8_t m = 0; m < num_modes; m++)
+    {
+        float brightness = powf(velocity, ratio[m] * 0.1f);
+        y1[m] += weight[m] * velocity * brightness * radius[m] * sin_w[m];
+    }
+    ringing = true;
+}
+
+void ModalBowl::release()
+{
+    if (!released)
+    {
+        released = true;
+        updateDamping();
+    }
+}
+
+void ModalBowl::render(uint32_t frames)
+{
+    memset(mix, 0, frames * sizeof(float));
+
+    // Mode by mode: the state stays in registers for the whole block
+    float energy = 0;
+    for (uint8_t m = 0; m < num_modes; m++)
+    {
+        float c1 = a1[m];
+        float c2 = a2[m];
+        float s1 = y1[m];
+        float s2 = y2[m];
+        for (uint32_t n = 0; n < frames; n++)
+        {
+            float y = c1 * s1 - c2 * s2;
+            mix[n] += y;
+            s2 = s1;
+            s1 = y;
+        }
+        y1[m] = s1;
+        y2[m] = s2;
+        energy += fabsf(s1) + fabsf(s2);
+    }
+
+    // Below 1/4 LSB everywhere: stop computing
+    if (energy * output_gain < 0.25f)
+    {
+        memset(y1, 0, sizeof(y1));
+        memset(y2, 0, sizeof(y2));
+        ringing = false;
+    }
+}
+
+size_t ModalBowl::readBytes(uint8_t *data, size_t len)
+{
+    int16_t *out = (int16_t *)data;
+    uint8_t channels = info.channels;
+    uint32_t frames = len / (sizeof(int16_t) * channels);
+
+    // Mode changes from other tasks are applied between blocks
+    if (pending_modes != num_modes)
+    {
+        memset(y1, 0, sizeof(y1));
+        memset(y2, 0, sizeof(y2));
+        configureModes(pending_modes);
+    }
+    else if (pending_retune)
+    {
+        pending_retune = false;
+        configureModes(num_modes);
+    }
+
+    uint32_t done = 0;
+    while (done < frames)
+    {
+        uint32_t n = min(frames - done, (uint32_t)BLOCK_FRAMES);
+        int16_t *dst = out + done * channels;
+
+        if (!ringing)
+        {
+            memset(dst, 0, n * channels * sizeof(int16_t));
+        }
+        else
+        {
+            render(n);
+            for (uint32_t i = 0; i < n; i++)
+            {
+                int32_t sample = (int32_t)(mix[i] * output_gain);
+                sample = constrain(sample, -32768, 32767);
+                for (uint8_t c = 0; c < channels; c++)
+                {
+                    *dst++ = sample;
+                }
+            }
+        }
+        done += n;
+    }
+
+    return frames * channels * sizeof(int16_t);
+}
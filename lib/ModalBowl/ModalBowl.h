@@ -0,0 +1,84 @@
+#ifndef MODALBOWL_H
+#define MODALBOWL_H
+
+#include "Arduino.h"
+#include "AudioTools.h"
+#include <AudioConfig.h>
+#include <AsyncLog.h>
+#include <Voice.h>
+
+// Physically modelled singing bowl: a bank of damped two-pole resonators.
+//
+// Each partial is a resonator y[n] = a1*y[n-1] - a2*y[n-2] tuned to an
+// inharmonic bowl ratio with its own decay (higher partials die faster).
+// A strike adds an impulse to every resonator's state, velocity making
+// the upper partials brighter. With 16 modes each partial is a doublet
+// split by a few cents, the slow beating of a real bowl.
+//
+// State is kept as arrays over the modes and rendered mode by mode over
+// the block, so the inner loop is three multiply-adds with no branch.
+class ModalBowl : public Voice, public audio_tools::AudioStream
+{
+public:
+    static const uint8_t MAX_MODES = 16;
+    static const uint8_t NUM_PARTIALS = 8;
+    static const uint16_t BLOCK_FRAMES = 128;
+
+private:
+    audio_tools::AudioInfo info;
+
+    // Per mode (structure of arrays)
+    float ratio[MAX_MODES];
+    float weight[MAX_MODES];   // strike amplitude at full velocity
+    float cos_w[MAX_MODES];
+    float sin_w[MAX_MODES];
+    float radius[MAX_MODES];
+    float a1[MAX_MODES];
+    float a2[MAX_MODES];
+    float y1[MAX_MODES];
+    float y2[MAX_MODES];
+
+    uint8_t num_modes;
+    volatile uint8_t pending_modes;
+    volatile bool pending_retune;
+    float fundamental;
+    float decay_seconds;   // fundamental T60
+    float release_seconds; // T60 once released (hand on the rim)
+    float split_cents;     // doublet spacing with 16 modes
+    float output_gain;
+    bool released;
+    bool ringing;
+
+    float mix[BLOCK_FRAMES];
+
+public:
+    ModalBowl();
+
+    bool begin(audio_tools::AudioInfo audioInfo);
+
+    // Voice
+    void strike(float frequency = 220.0f, float velocity = 1.0f) override;
+    void release() override;
+    bool isActive() const override { return ringing; }
+    audio_tools::AudioStream *getAudioStream() override { return this; }
+
+    // Configuration
+    void setModes(uint8_t count); // 8 or 16
+    void setDecay(float seconds);
+    void setRelease(float seconds);
+    void setSplit(float cents);
+    uint8_t getModes() const { return num_modes; }
+
+    // AudioStream
+    size_t readBytes(uint8_t *data, size_t len) override;
+    size_t write(const uint8_t *data, size_t len) override { return 0; }
+    int available() override { return DEFAULT_BUFFER_SIZE; }
+
+private:
+    void configureModes(uint8_t count);
+    void tune();
+    void updateDamping();
+    void render(uint32_t frames);
+};
+
+#endif // MODALBOWL_H
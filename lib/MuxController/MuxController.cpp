@@ -10,11 +10,11 @@ MuxController::MuxController() {
 void MuxController::readNext() {
   mux[activeMux]->readNext();  // lit le canal courant du mux actif
 
-  /** Avancer dans le canal
+  // Avancer dans le canal (les 32 pots alimentent la ModMatrix)
   if (mux[activeMux]->getCurrentIndex() == 0) {
     // Si le mux vient de repasser à 0 → tous ses 16 canaux ont été lus
     activeMux = (activeMux + 1) % 2; // on passe au mux suivant
-  }*/
+  }
 }
 uint16_t MuxController::get(uint8_t muxIndex, uint8_t channelIndex) {
   if (muxIndex >= 2 || channelIndex >= 16) return 0.0;
@@ -0,0 +1,278 @@
+#include <PatternEngine.h>
+
+PatternEngine::PatternEngine()
+    : sequencer(nullptr), generatorTaskHandle(NULL), generator(nullptr), num_steps(0),
+      stage(IDLE), staged_mutation(false), swap_id(0), stage_lock(portMUX_INITIALIZER_UNLOCKED),
+      requested(nullptr), requested_steps(0), mutator(nullptr), num_edits(0),
+      last_generate_us(0), max_generate_us(0), swaps(0), bars_evolved(0), steps_mutated(0)
+{
+}
+
+PatternEngine::~PatternEngine()
+{
+    if (generatorTaskHandle)
+    {
+        vTaskDelete(generatorTaskHandle);
+    }
+}
+
+bool PatternEngine::begin(Sequencer *seq)
+{
+    sequencer = seq;
+    if (!sequencer)
+    {
+        return false;
+    }
+
+    sequencer->setPatternSwapHandler(onPatternSwap, this);
+
+    if (!generatorTaskHandle)
+    {
+        // Generation runs on Core 0, away from the audio task
+        xTaskCreatePinnedToCore(
+            generatorTask,
+            "GeneratorTask",
+            4096,
+            this,
+            1, // normal priority
+            &generatorTaskHandle,
+            0 // Core 0
+        );
+    }
+
+    return generatorTaskHandle != NULL;
+}
+
+bool PatternEngine::request(PatternGenerator *gen, uint16_t steps)
+{
+    if (!gen || !generatorTaskHandle)
+    {
+        return false;
+    }
+
+    portENTER_CRITICAL(&stage_lock);
+    if (isBusy())
+    {
+        portEXIT_CRITICAL(&stage_lock);
+        return false;
+    }
+    // The new pattern replaces the mutation waiting for the bar line
+    if (stage == READY)
+    {
+        stage = IDLE;
+    }
+    requested_steps = constrain(steps, (uint16_t)1, MAX_STEPS);
+    requested = gen;
+    portEXIT_CRITICAL(&stage_lock);
+
+    xTaskNotifyGive(generatorTaskHandle);
+    return true;
+}
+
+bool PatternEngine::claim(uint8_t from, uint8_t to)
+{
+    portENTER_CRITICAL(&stage_lock);
+    bool claimed = stage == from;
+    if (claimed)
+    {
+        stage = to;
+    }
+    portEXIT_CRITICAL(&stage_lock);
+    return claimed;
+}
+
+bool PatternEngine::lockGenerators()
+{
+    // A mutation is built in well under a millisecond
+    for (uint8_t tries = 0; tries < 20; tries++)
+    {
+        portENTER_CRITICAL(&stage_lock);
+        if (isBusy())
+        {
+            portEXIT_CRITICAL(&stage_lock);
+            return false;
+        }
+        if (stage == READY)
+        {
+            stage = IDLE; // built with the old settings
+        }
+        bool locked = stage == IDLE;
+        if (locked)
+        {
+            stage = EDITING;
+        }
+        portEXIT_CRITICAL(&stage_lock);
+
+        if (locked)
+        {
+            return true;
+        }
+        vTaskDelay(1);
+    }
+    return false;
+}
+
+void PatternEngine::unlockGenerators()
+{
+    claim(EDITING, IDLE);
+    if ((mutator || requested) && generatorTaskHandle)
+    {
+        xTaskNotifyGive(generatorTaskHandle);
+    }
+}
+
+void PatternEngine::generatorTask(void *parameter)
+{
+    PatternEngine *engine = static_cast<PatternEngine *>(parameter);
+
+    while (true)
+    {
+        // Woken by a request or a swap; polls while evolving and stopped
+        ulTaskNotifyTake(pdTRUE, engine->mutator ? pdMS_TO_TICKS(100) : portMAX_DELAY);
+
+        bool playing = engine->sequencer->getState() == Sequencer::PLAYING;
+        PatternMutator *mut = engine->mutator;
+
+        // Claim the staging table for a request first, else for a mutation
+        portENTER_CRITICAL(&engine->stage_lock);
+        bool generate = engine->stage == IDLE && engine->requested;
+        bool mutate = !generate && engine->stage == IDLE && mut && playing;
+        if (generate)
+        {
+            engine->generator = engine->requested;
+            engine->num_steps = engine->requested_steps;
+            engine->requested = nullptr;
+        }
+        if (generate || mutate)
+        {
+            engine->stage = BUILDING;
+            engine->staged_mutation = mutate;
+        }
+        portEXIT_CRITICAL(&engine->stage_lock);
+
+        if (generate)
+        {
+            engine->generateStaged();
+        }
+        else if (mutate)
+        {
+            engine->mutateStaged(mut);
+        }
+    }
+}
+
+void PatternEngine::setEvolution(PatternMutator *mut)
+{
+    mutator = mut;
+    if (mutator && generatorTaskHandle)
+    {
+        xTaskNotifyGive(generatorTaskHandle);
+    }
+}
+
+void PatternEngine::generateStaged()
+{
+    uint32_t start = micros();
+    generator->generate(staging, num_steps);
+    last_generate_us = micros() - start;
+    max_generate_us = max(max_generate_us, last_generate_us);
+
+    num_edits = 0;
+    if (!scheduleSwap())
+    {
+        LOG_PRINTLN("⚠️ Event queue full, pattern dropped");
+    }
+}
+
+void PatternEngine::mutateStaged(PatternMutator *mut)
+{
+    // Word reads of the playing pattern, then a bounded set of changes
+    num_steps = min(sequencer->getNumSteps(), MAX_STEPS);
+    for (uint16_t i = 0; i < num_steps; i++)
+    {
+        staging[i] = sequencer->getStep(i);
+    }
+
+    uint32_t start = micros();
+    num_edits = mut->mutate(staging, num_steps, edits, MAX_EDITS);
+    last_generate_us = micros() - start;
+    max_generate_us = max(max_generate_us, last_generate_us);
+
+    if (num_edits == 0 || requested)
+    {
+        // Nothing drawn this time, or a pattern came in meanwhile (its
+        // notification wakes the next pass)
+        stage = IDLE;
+        return;
+    }
+    scheduleSwap();
+}
+
+bool PatternEngine::scheduleSwap()
+{
+    // Swap on the next bar line (right away if stopped)
+    swap_id++;
+    uint16_t id = swap_id;
+    if (!claim(BUILDING, READY))
+    {
+        return false;
+    }
+    if (!sequencer->schedulePatternSwap(sequencer->nextBarTime(), id))
+    {
+        claim(READY, IDLE);
+        return false;
+    }
+    return true;
+}
+
+void PatternEngine::onPatternSwap(void *context, uint16_t pattern)
+{
+    PatternEngine *engine = static_cast<PatternEngine *>(context);
+
+    // A dropped mutation leaves its event behind: the id tells them apart
+    portENTER_CRITICAL(&engine->stage_lock);
+    bool apply = engine->stage == READY && pattern == engine->swap_id;
+    if (apply)
+    {
+        engine->stage = APPLYING;
+    }
+    portEXIT_CRITICAL(&engine->stage_lock);
+
+    if (apply)
+    {
+        engine->applyStaged();
+    }
+}
+
+void PatternEngine::applyStaged()
+{
+    // Audio task: plain word copies, nothing else
+    if (num_edits)
+    {
+        for (uint8_t i = 0; i < num_edits; i++)
+        {
+            sequencer->setTrackStep(0, edits[i], staging[edits[i]]);
+        }
+        bars_evolved++;
+        steps_mutated += num_edits;
+    }
+    else
+    {
+        for (uint16_t i = 0; i < num_steps; i++)
+        {
+            sequencer->setTrackStep(0, i, staging[i]);
+            sequencer->setTrackMicroOffset(0, i, 0);
+        }
+        sequencer->setNumSteps(num_steps);
+        swaps++;
+    }
+
+    stage = IDLE;
+
+    // Next bar's mutation (or a pattern requested meanwhile) is prepared
+    // right away on Core 0
+    if (mutator || requested)
+    {
+        xTaskNotifyGive(generatorTaskHandle);
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef PATTERNENGINE_H
+#define PATTERNENGINE_H
+
+#include "Arduino.h"
+#include <AsyncLog.h>
+#include <Sequencer.h>
+#include <PatternGenerator.h>
+
+// Runs pattern generators on Core 0 and hands the result to the sequencer.
+//
+// request() only wakes the generator task. The new pattern is built in a
+// staging table, then swapped into track 0 by a pattern swap event on the
+// next bar line: the audio task only copies the finished steps.
+//
+// In evolution mode the task also mutates a few steps of the playing
+// pattern for every bar, and only the changed steps are copied at the bar
+// line: the pattern keeps evolving without any stop/start.
+//
+// The staging table has one owner at a time, claimed under stage_lock:
+// the generator task while BUILDING, the audio task while APPLYING, a
+// control task while EDITING. A request always wins over a mutation: a
+// staged one is dropped, one being built is discarded when done.
+class PatternEngine
+{
+public:
+    static const uint16_t MAX_STEPS = 128;
+    static const uint8_t MAX_EDITS = 16; // per bar
+
+    enum Stage
+    {
+        IDLE,
+        BUILDING, // generator task fills the staging table
+        READY,    // waiting for the bar line
+        APPLYING, // audio task copies it
+        EDITING   // a control task changes the generators
+    };
+
+private:
+    Sequencer *sequencer;
+    TaskHandle_t generatorTaskHandle;
+
+    PatternGenerator *generator;
+    uint16_t num_steps;
+    Sequencer::Step staging[MAX_STEPS];
+    volatile uint8_t stage;
+    volatile bool staged_mutation; // what BUILDING/READY/APPLYING hold
+    volatile uint16_t swap_id;
+    portMUX_TYPE stage_lock;
+
+    // Next pattern, taken by the generator task as soon as staging is free
+    PatternGenerator *volatile requested;
+    uint16_t requested_steps;
+
+    // Evolution: steps changed for the next bar (all of them if num_edits == 0)
+    PatternMutator *volatile mutator;
+    uint16_t edits[MAX_EDITS];
+    uint8_t num_edits;
+
+    // Stats
+    uint32_t last_generate_us;
+    uint32_t max_generate_us;
+    uint32_t swaps;
+    uint32_t bars_evolved;
+    uint32_t steps_mutated;
+
+public:
+    PatternEngine();
+    ~PatternEngine();
+
+    bool begin(Sequencer *seq);
+
+    // Any task; false while a previous pattern is on its way
+    bool request(PatternGenerator *gen, uint16_t steps);
+    bool isBusy() const { return requested || (stage != IDLE && stage != EDITING && !staged_mutation); }
+
+    // Exclusive use of the generators from a control task (scale, seeds,
+    // mutator settings). Drops a staged mutation, waits for one being
+    // built; false while a pattern is on its way
+    bool lockGenerators();
+    void unlockGenerators();
+
+    // Per-bar mutation of the playing pattern (nullptr = off)
+    void setEvolution(PatternMutator *mut);
+    bool isEvolving() const { return mutator != nullptr; }
+
+    uint32_t getLastGenerateUs() const { return last_generate_us; }
+    uint32_t getMaxGenerateUs() const { return max_generate_us; }
+    uint32_t getSwaps() const { return swaps; }
+    uint32_t getBarsEvolved() const { return bars_evolved; }
+    uint32_t getStepsMutated() const { return steps_mutated; }
+
+private:
+    static void generatorTask(void *parameter);
+    static void onPatternSwap(void *context, uint16_t pattern);
+    bool claim(uint8_t from, uint8_t to);
+    void generateStaged();
+    void mutateStaged(PatternMutator *mut);
+    bool scheduleSwap();
+    void applyStaged();
+};
+
+#endif // PATTERNENGINE_H
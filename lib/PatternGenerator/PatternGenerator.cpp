@@ -0,0 +1,550 @@
+#include <PatternGenerator.h>
+
+// Semitones from the root, per mode
+static const uint8_t mode_intervals[Scale::MODE_COUNT][7] = {
+    {0, 2, 4, 5, 7, 9, 11}, // major
+    {0, 2, 3, 5, 7, 8, 10}, // minor
+    {0, 2, 3, 5, 7, 9, 10}, // dorian
+    {0, 1, 3, 5, 7, 8, 10}, // phrygian
+    {0, 2, 4, 5, 7, 9, 10}, // mixolydian
+    {0, 3, 5, 7, 10},       // pentatonic minor
+    {0, 2, 4, 7, 9}};       // pentatonic major
+
+static const uint8_t mode_sizes[Scale::MODE_COUNT] = {7, 7, 7, 7, 7, 5, 5};
+
+static const char *mode_names[Scale::MODE_COUNT] = {
+    "major", "minor", "dorian", "phrygian", "mixolydian", "pentatonic minor", "pentatonic major"};
+
+// ----------------------------------------------------------------------------
+// Scale
+// ----------------------------------------------------------------------------
+
+void Scale::set(uint8_t root_note, Mode scale_mode)
+{
+    root = min(root_note, (uint8_t)(Sequencer::getNumAvailableNotes() - 1));
+    mode = scale_mode < MODE_COUNT ? scale_mode : PENTATONIC_MINOR;
+}
+
+uint8_t Scale::size() const
+{
+    return mode_sizes[mode];
+}
+
+uint8_t Scale::noteAt(int16_t degree) const
+{
+    int16_t n = size();
+    int16_t octave = degree >= 0 ? degree / n : -((n - 1 - degree) / n);
+    int16_t note = root + octave * 12 + mode_intervals[mode][degree - octave * n];
+    return constrain(note, 0, Sequencer::getNumAvailableNotes() - 1);
+}
+
+int16_t Scale::degreeOf(uint8_t note) const
+{
+    int16_t n = size();
+    int16_t diff = (int16_t)note - root;
+    int16_t octave = diff >= 0 ? diff / 12 : -((11 - diff) / 12);
+    int16_t semitones = diff - octave * 12;
+
+    // Nearest interval, the next octave's root included
+    int16_t best = 0;
+    int16_t best_distance = 12;
+    for (int16_t i = 0; i <= n; i++)
+    {
+        int16_t interval = i < n ? mode_intervals[mode][i] : 12;
+        int16_t distance = abs(semitones - interval);
+        if (distance < best_distance)
+        {
+            best_distance = distance;
+            best = i;
+        }
+    }
+    return octave * n + best;
+}
+
+bool Scale::isChordTone(int16_t degree, int16_t chord_degree) const
+{
+    int16_t n = size();
+    int16_t relative = ((degree - chord_degree) % n + n) % n;
+    return relative == 0 || relative == 2 || relative == 4;
+}
+
+int16_t Scale::nearestChordTone(int16_t degree, int16_t chord_degree) const
+{
+    for (int16_t distance = 0; distance < size(); distance++)
+    {
+        if (isChordTone(degree - distance, chord_degree))
+        {
+            return degree - distance;
+        }
+        if (isChordTone(degree + distance, chord_degree))
+        {
+            return degree + distance;
+        }
+    }
+    return chord_degree;
+}
+
+const char *Scale::modeName(Mode mode)
+{
+    return mode < MODE_COUNT ? mode_names[mode] : "?";
+}
+
+// ----------------------------------------------------------------------------
+// PatternGenerator
+// ----------------------------------------------------------------------------
+
+PatternGenerator::PatternGenerator() : num_chords(1), rng_state(0x9E3779B9)
+{
+    memset(chords, 0, sizeof(chords));
+}
+
+void PatternGenerator::setChords(const int8_t *degrees, uint8_t count)
+{
+    num_chords = constrain(count, (uint8_t)1, MAX_CHORDS);
+    for (uint8_t i = 0; i < num_chords; i++)
+    {
+        chords[i] = count ? degrees[i] : 0;
+    }
+}
+
+uint32_t PatternGenerator::nextRandom()
+{
+    // xorshift32
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+int16_t PatternGenerator::chordAt(uint16_t step) const
+{
+    return chords[(step / BAR_STEPS) % num_chords];
+}
+
+int16_t PatternGenerator::randomChordTone(uint16_t step)
+{
+    return chordAt(step) + 2 * randomBelow(3);
+}
+
+Sequencer::Step PatternGenerator::makeNote(int16_t degree, uint8_t velocity, uint8_t gate, bool accent) const
+{
+    return Sequencer::Step(Sequencer::Step::pack(true, scale.noteAt(degree), 0,
+                                                 min(velocity, (uint8_t)127),
+                                                 constrain(gate, (uint8_t)1, (uint8_t)100),
+                                                 accent ? Sequencer::Step::FLAG_ACCENT : 0));
+}
+
+// ----------------------------------------------------------------------------
+// EuclideanGenerator
+// ----------------------------------------------------------------------------
+
+void EuclideanGenerator::setRhythm(uint8_t new_hits, uint8_t new_pulses, uint8_t new_rotation)
+{
+    pulses = constrain(new_pulses, (uint8_t)1, (uint8_t)64);
+    hits = min(new_hits, pulses);
+    rotation = new_rotation % pulses;
+}
+
+bool EuclideanGenerator::isHit(uint16_t step) const
+{
+    // Bresenham form of Bjorklund: same onsets, no recursion
+    uint16_t i = (step + rotation) % pulses;
+    return (i * hits) % pulses < hits;
+}
+
+void EuclideanGenerator::generate(Sequencer::Step *steps, uint16_t num_steps)
+{
+    for (uint16_t i = 0; i < num_steps; i++)
+    {
+        if (!isHit(i))
+        {
+            steps[i] = Sequencer::Step();
+            continue;
+        }
+
+        bool downbeat = (i % pulses) == (pulses - rotation) % pulses;
+        bool on_beat = (i % 4) == 0;
+
+        // Chord root on the downbeat, other chord tones elsewhere
+        int16_t degree = downbeat ? chordAt(i) : randomChordTone(i);
+        uint8_t velocity = downbeat ? 120 : on_beat ? randomBetween(90, 110) : randomBetween(60, 90);
+        uint8_t gate = randomBetween(30, 60);
+
+        steps[i] = makeNote(degree, velocity, gate, downbeat);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// MarkovGenerator
+// ----------------------------------------------------------------------------
+
+MarkovGenerator::MarkovGenerator()
+{
+    forget();
+}
+
+void MarkovGenerator::forget()
+{
+    memset(transitions, 0, sizeof(transitions));
+    memset(row_total, 0, sizeof(row_total));
+    memset(velocity_sum, 0, sizeof(velocity_sum));
+    memset(gate_sum, 0, sizeof(gate_sum));
+    memset(visits, 0, sizeof(visits));
+}
+
+uint8_t MarkovGenerator::stateOf(const Sequencer::Step &step) const
+{
+    if (!step.active())
+    {
+        return 0;
+    }
+    return 1 + constrain(scale.degreeOf(step.note()), 0, MAX_DEGREES - 1);
+}
+
+void MarkovGenerator::train(const Sequencer::Step *steps, uint16_t num_steps)
+{
+    if (num_steps < 2)
+    {
+        return;
+    }
+
+    // Wraps around: the last step leads back to the first
+    uint8_t previous = stateOf(steps[num_steps - 1]);
+    for (uint16_t i = 0; i < num_steps; i++)
+    {
+        uint8_t state = stateOf(steps[i]);
+
+        if (row_total[previous] == 0xFFFF || visits[state] == 0xFFFF)
+        {
+            halveCounts();
+        }
+        transitions[previous][state]++;
+        row_total[previous]++;
+
+        if (state)
+        {
+            velocity_sum[state] += steps[i].velocity();
+            gate_sum[state] += steps[i].gateLength();
+        }
+        visits[state]++;
+
+        previous = state;
+    }
+}
+
+void MarkovGenerator::halveCounts()
+{
+    // Older patterns fade, recent ones keep teaching
+    for (uint8_t from = 0; from < NUM_STATES; from++)
+    {
+        row_total[from] = 0;
+        for (uint8_t to = 0; to < NUM_STATES; to++)
+        {
+            transitions[from][to] /= 2;
+            row_total[from] += transitions[from][to];
+        }
+        velocity_sum[from] /= 2;
+        gate_sum[from] /= 2;
+        visits[from] /= 2;
+    }
+}
+
+uint32_t MarkovGenerator::getTrainedTransitions() const
+{
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < NUM_STATES; i++)
+    {
+        total += row_total[i];
+    }
+    return total;
+}
+
+uint8_t MarkovGenerator::nextState(uint8_t state)
+{
+    uint16_t total = row_total[state];
+    if (total == 0)
+    {
+        // Unknown state: back to the root or a rest
+        return randomBelow(2) ? 1 : 0;
+    }
+
+    uint32_t pick = randomBelow(total);
+    for (uint8_t to = 0; to < NUM_STATES; to++)
+    {
+        if (pick < transitions[state][to])
+        {
+            return to;
+        }
+        pick -= transitions[state][to];
+    }
+    return 0;
+}
+
+void MarkovGenerator::generate(Sequencer::Step *steps, uint16_t num_steps)
+{
+    uint8_t state = 1; // start from the root
+    for (uint16_t i = 0; i < num_steps; i++)
+    {
+        state = nextState(state);
+        if (state == 0)
+        {
+            steps[i] = Sequencer::Step();
+            continue;
+        }
+
+        int16_t degree = state - 1;
+
+        // Bar downbeats land on the current chord
+        bool downbeat = (i % BAR_STEPS) == 0;
+        if (downbeat)
+        {
+            degree = constrain(scale.nearestChordTone(degree, chordAt(i)), 0, MAX_DEGREES - 1);
+            state = degree + 1;
+        }
+
+        // Velocity and gate: what the state had in training, slightly varied
+        uint16_t count = max(visits[state], (uint16_t)1);
+        int16_t velocity = visits[state] ? velocity_sum[state] / count : 90;
+        int16_t gate = visits[state] ? gate_sum[state] / count : 50;
+        velocity += randomBetween(-10, 11);
+        gate += randomBetween(-5, 6);
+
+        steps[i] = makeNote(degree, constrain(velocity, 1, 127), constrain(gate, 1, 100), downbeat);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// ScaleWalkGenerator
+// ----------------------------------------------------------------------------
+
+void ScaleWalkGenerator::generate(Sequencer::Step *steps, uint16_t num_steps)
+{
+    int16_t degree = chordAt(0);
+    for (uint16_t i = 0; i < num_steps; i++)
+    {
+        bool on_beat = (i % 4) == 0;
+
+        // Beats are always played, off-beats follow the density
+        if (!on_beat && randomBelow(100) >= density)
+        {
+            steps[i] = Sequencer::Step();
+            continue;
+        }
+
+        if (on_beat)
+        {
+            // Closest chord tone to where the line already is
+            degree = scale.nearestChordTone(degree, chordAt(i));
+        }
+        else
+        {
+            // Step or skip, mostly stepwise
+            static const int8_t moves[] = {-2, -1, -1, 1, 1, 2};
+            degree += moves[randomBelow(sizeof(moves))];
+        }
+
+        // Fold back into range
+        if (degree < 0)
+        {
+            degree = -degree;
+        }
+        if (degree > span)
+        {
+            degree = 2 * span - degree;
+        }
+
+        uint8_t velocity = on_beat ? randomBetween(90, 120) : randomBetween(50, 85);
+        uint8_t gate = on_beat ? randomBetween(50, 90) : randomBetween(25, 50);
+        steps[i] = makeNote(degree, velocity, gate, (i % BAR_STEPS) == 0);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// PatternMutator
+// ----------------------------------------------------------------------------
+
+PatternMutator::PatternMutator() : max_edits(4), rate(50)
+{
+    setWeights(50, 25, 20, 5);
+
+    limits.max_leap = 2;
+    limits.max_degree = 12;
+    limits.min_velocity = 30;
+    limits.max_velocity = 120;
+    limits.min_gate = 10;
+    limits.max_gate = 95;
+    limits.min_density = 40;
+    limits.max_density = 90;
+    limits.keep_beats = true;
+}
+
+void PatternMutator::setRate(uint8_t edits_per_call, uint8_t percent)
+{
+    max_edits = min(edits_per_call, (uint8_t)16);
+    rate = min(percent, (uint8_t)100);
+}
+
+void PatternMutator::setWeights(uint8_t note, uint8_t velocity, uint8_t gate, uint8_t toggle)
+{
+    weights[0] = note;
+    weights[1] = velocity;
+    weights[2] = gate;
+    weights[3] = toggle;
+}
+
+void PatternMutator::generate(Sequencer::Step *steps, uint16_t num_steps)
+{
+    uint16_t changed[16];
+    mutate(steps, num_steps, changed, 16);
+}
+
+uint8_t PatternMutator::mutate(Sequencer::Step *steps, uint16_t num_steps, uint16_t *changed, uint8_t max_changed)
+{
+    uint16_t total_weight = weights[0] + weights[1] + weights[2] + weights[3];
+    if (num_steps == 0 || total_weight == 0)
+    {
+        return 0;
+    }
+
+    uint8_t count = 0;
+    uint8_t slots = min(max_edits, max_changed);
+    for (uint8_t slot = 0; slot < slots; slot++)
+    {
+        if (randomBelow(100) >= rate)
+        {
+            continue;
+        }
+
+        uint16_t index = randomBelow(num_steps);
+        Sequencer::Step &step = steps[index];
+
+        // Pick the kind of change
+        uint16_t pick = randomBelow(total_weight);
+        uint8_t op = 0;
+        while (pick >= weights[op])
+        {
+            pick -= weights[op];
+            op++;
+        }
+
+        bool done;
+        if (op == 3 || !step.active())
+        {
+            // Rests can only come back to life
+            done = toggle(steps, num_steps, index);
+        }
+        else if (op == 0)
+        {
+            done = mutateNote(step, index);
+        }
+        else if (op == 1)
+        {
+            done = mutateVelocity(step);
+        }
+        else
+        {
+            done = mutateGate(step);
+        }
+
+        // Each step reported once
+        if (done)
+        {
+            bool listed = false;
+            for (uint8_t i = 0; i < count; i++)
+            {
+                listed |= changed[i] == index;
+            }
+            if (!listed)
+            {
+                changed[count++] = index;
+            }
+        }
+    }
+    return count;
+}
+
+bool PatternMutator::mutateNote(Sequencer::Step &step, uint16_t index)
+{
+    int16_t leap = randomBetween(1, limits.max_leap + 1);
+    int16_t degree = scale.degreeOf(step.note()) + (randomBelow(2) ? leap : -leap);
+
+    // Downbeats stay on the chord
+    if (index % BAR_STEPS == 0)
+    {
+        degree = scale.nearestChordTone(degree, chordAt(index));
+    }
+    degree = constrain(degree, 0, (int16_t)limits.max_degree);
+
+    uint8_t note = scale.noteAt(degree);
+    if (note == step.note())
+    {
+        return false;
+    }
+    step = Sequencer::Step(Sequencer::Step::pack(true, note, 0, step.velocity(), step.gateLength(), step.flags()));
+    return true;
+}
+
+bool PatternMutator::mutateVelocity(Sequencer::Step &step)
+{
+    int16_t velocity = step.velocity() + randomBetween(-20, 21);
+    velocity = constrain(velocity, (int16_t)limits.min_velocity, (int16_t)limits.max_velocity);
+    if (velocity == step.velocity())
+    {
+        return false;
+    }
+    step = Sequencer::Step(Sequencer::Step::pack(true, step.note(), step.fineTune(), velocity, step.gateLength(), step.flags()));
+    return true;
+}
+
+bool PatternMutator::mutateGate(Sequencer::Step &step)
+{
+    int16_t gate = step.gateLength() + randomBetween(-15, 16);
+    gate = constrain(gate, (int16_t)limits.min_gate, (int16_t)limits.max_gate);
+    if (gate == step.gateLength())
+    {
+        return false;
+    }
+    step = Sequencer::Step(Sequencer::Step::pack(true, step.note(), step.fineTune(), step.velocity(), gate, step.flags()));
+    return true;
+}
+
+bool PatternMutator::toggle(Sequencer::Step *steps, uint16_t num_steps, uint16_t index)
+{
+    uint16_t active = 0;
+    for (uint16_t i = 0; i < num_steps; i++)
+    {
+        active += steps[i].active();
+    }
+    uint16_t density = active * 100 / num_steps;
+
+    Sequencer::Step &step = steps[index];
+    if (step.active())
+    {
+        if (density <= limits.min_density || (limits.keep_beats && index % 4 == 0))
+        {
+            return false;
+        }
+        step = Sequencer::Step();
+        return true;
+    }
+
+    if (density >= limits.max_density)
+    {
+        return false;
+    }
+
+    // New note: a chord tone, dynamics borrowed from the previous active step
+    uint16_t previous = index;
+    do
+    {
+        previous = previous ? previous - 1 : num_steps - 1;
+    } while (previous != index && !steps[previous].active());
+
+    uint8_t velocity = steps[previous].active() ? steps[previous].velocity() : 80;
+    uint8_t gate = steps[previous].active() ? steps[previous].gateLength() : 50;
+    int16_t degree = constrain(randomChordTone(index), 0, (int16_t)limits.max_degree);
+
+    step = makeNote(degree, constrain(velocity, limits.min_velocity, limits.max_velocity),
+                    constrain(gate, limits.min_gate, limits.max_gate));
+    return true;
+}
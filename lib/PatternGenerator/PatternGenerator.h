@@ -0,0 +1,202 @@
+#ifndef PATTERNGENERATOR_H
+#define PATTERNGENERATOR_H
+
+#include "Arduino.h"
+#include <Sequencer.h>
+
+// Key and mode: maps scale degrees to note table indexes.
+// Degree 0 is the root, degrees keep counting up through the octaves.
+class Scale
+{
+public:
+    enum Mode
+    {
+        MAJOR,
+        MINOR,
+        DORIAN,
+        PHRYGIAN,
+        MIXOLYDIAN,
+        PENTATONIC_MINOR,
+        PENTATONIC_MAJOR,
+        MODE_COUNT
+    };
+
+private:
+    uint8_t root; // note table index (33 = A2)
+    uint8_t mode;
+
+public:
+    Scale(uint8_t root_note = 33, Mode scale_mode = PENTATONIC_MINOR) : root(root_note), mode(scale_mode) {}
+
+    void set(uint8_t root_note, Mode scale_mode);
+    uint8_t getRoot() const { return root; }
+    Mode getMode() const { return (Mode)mode; }
+    uint8_t size() const; // degrees per octave
+
+    uint8_t noteAt(int16_t degree) const;
+    int16_t degreeOf(uint8_t note) const; // nearest degree
+
+    // Triad stacked in scale thirds on top of chord_degree
+    bool isChordTone(int16_t degree, int16_t chord_degree) const;
+    int16_t nearestChordTone(int16_t degree, int16_t chord_degree) const;
+
+    static const char *modeName(Mode mode);
+};
+
+// Base class of the pattern generators.
+//
+// A generator fills a step table from its own parameters, scale, chord
+// progression (one chord per 16-step bar) and private random state. Every
+// generator runs in O(steps) over fixed tables, with no allocation and no
+// global random(), so it is safe to call from any task.
+class PatternGenerator
+{
+public:
+    static const uint8_t MAX_CHORDS = 8;
+    static const uint8_t BAR_STEPS = 16;
+
+protected:
+    Scale scale;
+    int8_t chords[MAX_CHORDS]; // chord roots as scale degrees
+    uint8_t num_chords;
+    uint32_t rng_state;
+
+public:
+    PatternGenerator();
+    virtual ~PatternGenerator() {}
+
+    virtual const char *name() const = 0;
+    virtual void generate(Sequencer::Step *steps, uint16_t num_steps) = 0;
+
+    void setScale(const Scale &new_scale) { scale = new_scale; }
+    const Scale &getScale() const { return scale; }
+    void setChords(const int8_t *degrees, uint8_t count);
+    void setSeed(uint32_t seed) { rng_state = seed ? seed : 0x9E3779B9; }
+
+protected:
+    uint32_t nextRandom();
+    uint32_t randomBelow(uint32_t n) { return n ? nextRandom() % n : 0; }
+    int16_t randomBetween(int16_t low, int16_t high) { return low + randomBelow(high - low); }
+
+    int16_t chordAt(uint16_t step) const;
+    int16_t randomChordTone(uint16_t step);
+    Sequencer::Step makeNote(int16_t degree, uint8_t velocity, uint8_t gate, bool accent = false) const;
+};
+
+// Euclidean rhythm: `hits` onsets spread as evenly as possible over `pulses`
+// steps, rotated. Onsets play chord tones, the first one of the cycle accented.
+class EuclideanGenerator : public PatternGenerator
+{
+private:
+    uint8_t hits;
+    uint8_t pulses;
+    uint8_t rotation;
+
+public:
+    EuclideanGenerator() : hits(5), pulses(16), rotation(0) {}
+
+    const char *name() const override { return "euclidean"; }
+    void generate(Sequencer::Step *steps, uint16_t num_steps) override;
+
+    void setRhythm(uint8_t new_hits, uint8_t new_pulses, uint8_t new_rotation = 0);
+    bool isHit(uint16_t step) const;
+};
+
+// First-order Markov chain over scale degrees (plus a rest state), trained on
+// existing patterns. Degrees are taken relative to the generator's scale, so
+// patterns in any key teach the same movements.
+class MarkovGenerator : public PatternGenerator
+{
+public:
+    static const uint8_t MAX_DEGREES = 16;
+    static const uint8_t NUM_STATES = MAX_DEGREES + 1; // 0 = rest
+
+private:
+    uint16_t transitions[NUM_STATES][NUM_STATES];
+    uint16_t row_total[NUM_STATES];
+    uint32_t velocity_sum[NUM_STATES];
+    uint32_t gate_sum[NUM_STATES];
+    uint16_t visits[NUM_STATES];
+
+public:
+    MarkovGenerator();
+
+    const char *name() const override { return "markov"; }
+    void generate(Sequencer::Step *steps, uint16_t num_steps) override;
+
+    void train(const Sequencer::Step *steps, uint16_t num_steps);
+    void forget();
+    uint32_t getTrainedTransitions() const;
+
+private:
+    uint8_t stateOf(const Sequencer::Step &step) const;
+    uint8_t nextState(uint8_t state);
+    void halveCounts();
+};
+
+// Melodic walk: chord tones on the beats, stepwise motion in between,
+// density sets the share of active steps.
+class ScaleWalkGenerator : public PatternGenerator
+{
+private:
+    uint8_t density; // %
+    uint8_t span;    // degrees above the root
+
+public:
+    ScaleWalkGenerator() : density(70), span(10) {}
+
+    const char *name() const override { return "scale walk"; }
+    void generate(Sequencer::Step *steps, uint16_t num_steps) override;
+
+    void setDensity(uint8_t percent) { density = min(percent, (uint8_t)100); }
+    void setSpan(uint8_t degrees) { span = constrain(degrees, (uint8_t)2, (uint8_t)MarkovGenerator::MAX_DEGREES); }
+};
+
+// Evolves an existing pattern a few steps at a time.
+//
+// Each call to mutate() changes at most `max_edits` steps (note, velocity,
+// gate, or rest <-> note), within the limits below. Notes move by scale
+// degrees and bar downbeats stay on chord tones, so the pattern drifts
+// without leaving the key. generate() mutates the given table in place.
+class PatternMutator : public PatternGenerator
+{
+public:
+    struct Limits
+    {
+        uint8_t max_leap;                   // scale degrees per note move
+        uint8_t max_degree;                 // highest degree above the root
+        uint8_t min_velocity, max_velocity;
+        uint8_t min_gate, max_gate;
+        uint8_t min_density, max_density;   // % of active steps
+        bool keep_beats;                    // steps on the beat are never muted
+    };
+
+private:
+    uint8_t max_edits;
+    uint8_t rate; // % chance for each of the max_edits slots
+    uint8_t weights[4]; // note, velocity, gate, toggle
+    Limits limits;
+
+public:
+    PatternMutator();
+
+    const char *name() const override { return "mutator"; }
+    void generate(Sequencer::Step *steps, uint16_t num_steps) override;
+
+    // Returns the number of changed steps, their indexes in `changed`
+    uint8_t mutate(Sequencer::Step *steps, uint16_t num_steps, uint16_t *changed, uint8_t max_changed);
+
+    void setRate(uint8_t edits_per_call, uint8_t percent);
+    void setWeights(uint8_t note, uint8_t velocity, uint8_t gate, uint8_t toggle);
+    void setLimits(const Limits &new_limits) { limits = new_limits; }
+    const Limits &getLimits() const { return limits; }
+    uint8_t getMaxEdits() const { return max_edits; }
+
+private:
+    bool mutateNote(Sequencer::Step &step, uint16_t index);
+    bool mutateVelocity(Sequencer::Step &step);
+    bool mutateGate(Sequencer::Step &step);
+    bool toggle(Sequencer::Step *steps, uint16_t num_steps, uint16_t index);
+};
+
+#endif // PATTERNGENERATOR_H
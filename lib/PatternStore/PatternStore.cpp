@@ -0,0 +1,270 @@
+#include <PatternStore.h>
+
+static const char *style_names[PatternStore::STYLE_COUNT] = {
+    "tibetan",
+    "acid",
+    "ambient"};
+
+PatternStore::PatternStore()
+    : sequencer(nullptr), filesystem(nullptr), streamTaskHandle(NULL), fileMutex(NULL),
+      streaming(false), num_pages(0), last_play_half(0), page_loads(0), late_pages(0)
+{
+    memset(&header, 0, sizeof(header));
+    page_in_half[0] = -1;
+    page_in_half[1] = -1;
+}
+
+PatternStore::~PatternStore()
+{
+    stop();
+    if (streamTaskHandle)
+    {
+        vTaskDelete(streamTaskHandle);
+    }
+    if (fileMutex)
+    {
+        vSemaphoreDelete(fileMutex);
+    }
+}
+
+bool PatternStore::begin(Sequencer *seq, fs::FS &fs)
+{
+    sequencer = seq;
+    filesystem = &fs;
+
+    if (!fileMutex)
+    {
+        fileMutex = xSemaphoreCreateMutex();
+    }
+
+    if (!streamTaskHandle)
+    {
+        // Page prefetch runs on Core 0, away from the audio task
+        xTaskCreatePinnedToCore(
+            streamTask,
+            "PatternTask",
+            4096,
+            this,
+            1, // normal priority
+            &streamTaskHandle,
+            0 // Core 0
+        );
+    }
+
+    return sequencer && fileMutex && streamTaskHandle;
+}
+
+bool PatternStore::save(const char *path, uint8_t style, uint16_t bpm)
+{
+    if (!sequencer || !filesystem)
+    {
+        return false;
+    }
+
+    fs::File out = filesystem->open(path, FILE_WRITE);
+    if (!out)
+    {
+        LOG_PRINTF("⚠️ Cannot create pattern file %s\n", path);
+        return false;
+    }
+
+    FileHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = MAGIC;
+    h.version = VERSION;
+    h.style = style;
+    h.bpm = bpm;
+    h.num_steps = sequencer->getNumSteps();
+    out.write((const uint8_t *)&h, sizeof(h));
+
+    uint32_t records[PAGE_STEPS];
+    for (uint32_t base = 0; base < h.num_steps; base += PAGE_STEPS)
+    {
+        uint32_t count = min((uint32_t)PAGE_STEPS, h.num_steps - base);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            records[i] = sequencer->getStep(base + i).bits;
+        }
+        out.write((const uint8_t *)records, count * sizeof(uint32_t));
+    }
+
+    out.close();
+    LOG_PRINTF("💾 Pattern saved: %s (%lu steps)\n", path, (unsigned long)h.num_steps);
+    return true;
+}
+
+bool PatternStore::load(const char *path, FileHeader &out_header)
+{
+    if (!sequencer || !filesystem)
+    {
+        return false;
+    }
+
+    stop();
+
+    xSemaphoreTake(fileMutex, portMAX_DELAY);
+
+    file = filesystem->open(path, FILE_READ);
+    if (!file || file.read((uint8_t *)&header, sizeof(header)) != sizeof(header) ||
+        header.magic != MAGIC || header.version != VERSION || header.num_steps == 0)
+    {
+        LOG_PRINTF("⚠️ Invalid pattern file %s\n", path);
+        if (file)
+        {
+            file.close();
+        }
+        memset(&header, 0, sizeof(header));
+        xSemaphoreGive(fileMutex);
+        return false;
+    }
+
+    out_header = header;
+    num_pages = (header.num_steps + PAGE_STEPS - 1) / PAGE_STEPS;
+
+    bool ok = true;
+    if (header.num_steps <= Sequencer::MAX_STEPS)
+    {
+        // Fits in RAM: load every page and forget the file
+        for (uint32_t page = 0; ok && page < num_pages; page++)
+        {
+            ok = readPage(page, page);
+        }
+        sequencer->setNumSteps(header.num_steps);
+        file.close();
+    }
+    else
+    {
+        ok = readPage(0, 0) && readPage(1, 1);
+        sequencer->setNumSteps(2 * PAGE_STEPS);
+        last_play_half = 0;
+        streaming = ok;
+    }
+
+    xSemaphoreGive(fileMutex);
+
+    LOG_PRINTF("📂 Pattern loaded: %s (%lu steps, %s, %d BPM%s)\n",
+               path, (unsigned long)header.num_steps, styleName(header.style), header.bpm,
+               streaming ? ", streaming" : "");
+    return ok;
+}
+
+void PatternStore::stop()
+{
+    if (!fileMutex)
+    {
+        return;
+    }
+
+    xSemaphoreTake(fileMutex, portMAX_DELAY);
+    if (streaming)
+    {
+        streaming = false;
+        file.close();
+    }
+    page_in_half[0] = -1;
+    page_in_half[1] = -1;
+    xSemaphoreGive(fileMutex);
+}
+
+const char *PatternStore::styleName(uint8_t style)
+{
+    return style < STYLE_COUNT ? style_names[style] : style_names[STYLE_TIBETAN];
+}
+
+uint8_t PatternStore::styleFromName(const String &name)
+{
+    for (uint8_t i = 0; i < STYLE_COUNT; i++)
+    {
+        if (name == style_names[i])
+        {
+            return i;
+        }
+    }
+    return STYLE_TIBETAN;
+}
+
+void PatternStore::streamTask(void *parameter)
+{
+    PatternStore *store = static_cast<PatternStore *>(parameter);
+
+    while (true)
+    {
+        if (store->streaming)
+        {
+            store->serviceStreaming();
+        }
+
+        // A page lasts at least 64 x 75 ms at 200 BPM: 10 ms polling is plenty
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+void PatternStore::serviceStreaming()
+{
+    xSemaphoreTake(fileMutex, portMAX_DELAY);
+    if (!streaming)
+    {
+        xSemaphoreGive(fileMutex);
+        return;
+    }
+
+    uint8_t play_half = sequencer->getCurrentStep() / PAGE_STEPS;
+    uint8_t other_half = 1 - play_half;
+
+    // The playhead just crossed a page boundary: was the page ready in time?
+    if (play_half != last_play_half)
+    {
+        int32_t expected = page_in_half[last_play_half] + 1;
+        if (page_in_half[play_half] != expected)
+        {
+            late_pages++;
+        }
+        last_play_half = play_half;
+    }
+
+    // Prefetch the page following the one being played
+    int32_t wanted = page_in_half[play_half] + 1;
+    if (page_in_half[other_half] != wanted)
+    {
+        readPage(wanted, other_half);
+    }
+
+    xSemaphoreGive(fileMutex);
+}
+
+bool PatternStore::readPage(uint32_t page, uint16_t slot)
+{
+    uint32_t records[PAGE_STEPS];
+
+    // The song loops without a gap: a page that runs past the last step
+    // goes on with the first ones, so the window never plays padding.
+    // Pages keep counting past the end of the song (page N starts at step
+    // N x PAGE_STEPS modulo the length).
+    uint32_t first = (uint64_t)page * PAGE_STEPS % header.num_steps;
+    uint8_t filled = 0;
+    while (filled < PAGE_STEPS)
+    {
+        uint32_t count = min((uint32_t)(PAGE_STEPS - filled), header.num_steps - first);
+        if (!file.seek(sizeof(FileHeader) + first * sizeof(uint32_t)) ||
+            file.read((uint8_t *)(records + filled), count * sizeof(uint32_t)) != count * sizeof(uint32_t))
+        {
+            LOG_PRINTF("⚠️ Pattern page %lu read error\n", (unsigned long)page);
+            return false;
+        }
+        filled += count;
+        first = 0;
+    }
+
+    uint16_t offset = slot * PAGE_STEPS;
+    for (uint8_t i = 0; i < PAGE_STEPS; i++)
+    {
+        sequencer->setStep(offset + i, Sequencer::Step(records[i]));
+    }
+
+    if (slot < 2)
+    {
+        page_in_half[slot] = page;
+    }
+    page_loads++;
+    return true;
+}
@@ -0,0 +1,89 @@
+#ifndef PATTERNSTORE_H
+#define PATTERNSTORE_H
+
+#include "Arduino.h"
+#include <AsyncLog.h>
+#include "FS.h"
+#include <Sequencer.h>
+
+// Binary pattern/preset files on SD card.
+//
+// File layout (little endian):
+//   FileHeader (16 bytes)
+//   uint32_t[num_steps], the packed Sequencer::Step words
+//
+// Patterns that fit in the sequencer are loaded at once. Longer ones are
+// streamed: the sequencer plays a two-page window, and a Core 0 task
+// refills the page the playhead just left with the next page of the song.
+// Pages are taken modulo the song length, so a song that is not a whole
+// number of pages loops straight from its last step to its first.
+class PatternStore
+{
+public:
+    static const uint32_t MAGIC = 0x54504D47; // "GMPT"
+    static const uint8_t VERSION = 2;
+    static const uint8_t PAGE_STEPS = 64;
+
+    enum Style : uint8_t
+    {
+        STYLE_TIBETAN = 0,
+        STYLE_ACID,
+        STYLE_AMBIENT,
+        STYLE_COUNT
+    };
+
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint8_t version;
+        uint8_t style;
+        uint16_t bpm;
+        uint32_t num_steps;
+        uint8_t reserved[4];
+    };
+
+private:
+    Sequencer *sequencer;
+    fs::FS *filesystem;
+    fs::File file;
+    FileHeader header;
+
+    // Streaming state
+    TaskHandle_t streamTaskHandle;
+    SemaphoreHandle_t fileMutex;
+    volatile bool streaming;
+    uint32_t num_pages;
+    int32_t page_in_half[2]; // Song page currently held by each window half, -1 = none
+    uint8_t last_play_half;
+    volatile uint32_t page_loads;
+    volatile uint32_t late_pages;
+
+public:
+    PatternStore();
+    ~PatternStore();
+
+    bool begin(Sequencer *seq, fs::FS &fs);
+
+    // Write the current sequencer pattern with its preset
+    bool save(const char *path, uint8_t style, uint16_t bpm);
+
+    // Load (or start streaming) a pattern; header is filled for the caller
+    bool load(const char *path, FileHeader &out_header);
+    void stop();
+
+    bool isStreaming() const { return streaming; }
+    uint32_t getSongLength() const { return header.num_steps; }
+    uint32_t getPageLoads() const { return page_loads; }
+    uint32_t getLatePages() const { return late_pages; }
+
+    // Preset names match Instrument::setupVCOs()
+    static const char *styleName(uint8_t style);
+    static uint8_t styleFromName(const String &name);
+
+private:
+    static void streamTask(void *parameter);
+    void serviceStreaming();
+    bool readPage(uint32_t page, uint16_t slot);
+};
+
+#endif // PATTERNSTORE_H
@@ -0,0 +1,147 @@
+#include <PowerManager.h>
+#include "esp_idf_version.h"
+
+#if ESP_IDF_VERSION_MAJOR >= 5
+typedef esp_pm_config_t pm_config_t;
+#else
+typedef esp_pm_config_esp32_t pm_config_t;
+#endif
+
+const uint16_t PowerManager::LEVEL_MHZ[PowerManager::NUM_LEVELS] = {80, 160, 240};
+
+// Load thresholds, as a fraction of the block duration
+static const float UP_LOAD = 0.6f;
+static const float DOWN_LOAD = 0.4f;
+
+PowerManager::PowerManager()
+    : enabled(false), use_pm_lock(false), pm_lock(nullptr), sample_rate(AUDIO_SAMPLE_RATE),
+      level(NUM_LEVELS - 1), window_peak(0), window_start_ms(0), last_load(0),
+      stats_lock(portMUX_INITIALIZER_UNLOCKED), last_update_us(0), peak_load(0), switches(0)
+{
+    memset(residency_us, 0, sizeof(residency_us));
+}
+
+bool PowerManager::begin(uint32_t rate)
+{
+    sample_rate = rate;
+
+    // Power management in the core: hold the max clock with a lock and
+    // move the max; light sleep stays off (I2S DMA must keep running)
+    pm_config_t config;
+    config.max_freq_mhz = LEVEL_MHZ[NUM_LEVELS - 1];
+    config.min_freq_mhz = LEVEL_MHZ[0];
+    config.light_sleep_enable = false;
+    use_pm_lock = esp_pm_configure(&config) == ESP_OK &&
+                  esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "audio", &pm_lock) == ESP_OK &&
+                  esp_pm_lock_acquire(pm_lock) == ESP_OK;
+
+    level = NUM_LEVELS - 1;
+    applyLevel(level);
+    window_start_ms = millis();
+    last_update_us = micros();
+    enabled = true;
+
+    LOG_PRINTF("⚡ PowerManager: %s, start at %d MHz\n",
+               use_pm_lock ? "esp_pm lock" : "setCpuFrequencyMhz", LEVEL_MHZ[level]);
+    return true;
+}
+
+void PowerManager::setEnabled(bool enable)
+{
+    enabled = enable;
+    if (!enabled)
+    {
+        // Off means full speed
+        applyLevel(NUM_LEVELS - 1);
+    }
+}
+
+void PowerManager::applyLevel(uint8_t next)
+{
+    if (use_pm_lock)
+    {
+        // The lock pins the CPU to max_freq_mhz
+        pm_config_t config;
+        config.max_freq_mhz = LEVEL_MHZ[next];
+        config.min_freq_mhz = LEVEL_MHZ[0];
+        config.light_sleep_enable = false;
+        esp_pm_configure(&config);
+    }
+    else
+    {
+        setCpuFrequencyMhz(LEVEL_MHZ[next]);
+    }
+
+    if (next != level)
+    {
+        level = next;
+        portENTER_CRITICAL(&stats_lock);
+        switches++;
+        portEXIT_CRITICAL(&stats_lock);
+    }
+}
+
+void PowerManager::update(uint32_t busy_us, uint32_t frames)
+{
+    uint32_t now_us = micros();
+    uint8_t previous = level;
+
+    if (frames > 0)
+    {
+        float block_us = frames * 1e6f / sample_rate;
+        last_load = busy_us / block_us;
+    }
+    window_peak = max(window_peak, last_load);
+
+    if (enabled)
+    {
+        uint32_t now_ms = millis();
+        if (last_load > UP_LOAD && level < NUM_LEVELS - 1)
+        {
+            // Never wait to go up: straight to the top
+            applyLevel(NUM_LEVELS - 1);
+            window_peak = 0;
+            window_start_ms = now_ms;
+        }
+        else if (now_ms - window_start_ms >= HOLD_MS)
+        {
+            // The worst block of the window, run at the lower clock
+            if (level > 0 && window_peak * LEVEL_MHZ[level] / LEVEL_MHZ[level - 1] < DOWN_LOAD)
+            {
+                applyLevel(level - 1);
+            }
+            window_peak = 0;
+            window_start_ms = now_ms;
+        }
+    }
+
+    portENTER_CRITICAL(&stats_lock);
+    residency_us[previous] += now_us - last_update_us;
+    peak_load = max(peak_load, last_load);
+    portEXIT_CRITICAL(&stats_lock);
+    last_update_us = now_us;
+}
+
+PowerManager::Residency PowerManager::readResidency()
+{
+    Residency residency;
+
+    portENTER_CRITICAL(&stats_lock);
+    uint64_t total = 0;
+    for (uint8_t i = 0; i < NUM_LEVELS; i++)
+    {
+        total += residency_us[i];
+    }
+    for (uint8_t i = 0; i < NUM_LEVELS; i++)
+    {
+        residency.percent[i] = total ? residency_us[i] * 100.0f / total : 0.0f;
+        residency_us[i] = 0;
+    }
+    residency.peak_load = peak_load;
+    residency.switches = switches;
+    peak_load = 0;
+    switches = 0;
+    portEXIT_CRITICAL(&stats_lock);
+
+    return residency;
+}
@@ -0,0 +1,70 @@
+#ifndef POWERMANAGER_H
+#define POWERMANAGER_H
+
+#include "Arduino.h"
+#include "esp_pm.h"
+#include <AudioConfig.h>
+#include <AsyncLog.h>
+
+// CPU clock follows the DSP load of the audio task: 80, 160 or 240 MHz.
+//
+// Called once per audio block with the time spent rendering it. A block
+// above 60 % load sends the clock straight to 240 MHz (the DMA buffers give
+// the time to get there); stepping down needs the worst block of the last
+// HOLD_MS to stay under 40 % once rescaled to the lower clock. The
+// clock is set through an ESP_PM_CPU_FREQ_MAX lock when the core is built
+// with power management, setCpuFrequencyMhz() otherwise.
+class PowerManager
+{
+public:
+    static const uint8_t NUM_LEVELS = 3;
+    static const uint32_t HOLD_MS = 2000;
+
+private:
+    static const uint16_t LEVEL_MHZ[NUM_LEVELS];
+
+    bool enabled;
+    bool use_pm_lock;
+    esp_pm_lock_handle_t pm_lock;
+    uint32_t sample_rate;
+
+    uint8_t level;
+    float window_peak;       // worst block load since window_start
+    uint32_t window_start_ms;
+    float last_load;
+
+    // Time spent at each level since the last readResidency()
+    mutable portMUX_TYPE stats_lock;
+    uint32_t last_update_us;
+    uint64_t residency_us[NUM_LEVELS];
+    float peak_load;
+    uint32_t switches;
+
+public:
+    struct Residency
+    {
+        float percent[NUM_LEVELS];
+        float peak_load; // worst block, at the clock it ran at
+        uint32_t switches;
+    };
+
+    PowerManager();
+
+    bool begin(uint32_t rate);
+    void setEnabled(bool enable);
+
+    // Audio task, after each block
+    void update(uint32_t busy_us, uint32_t frames);
+
+    uint16_t getFrequencyMhz() const { return LEVEL_MHZ[level]; }
+    static uint16_t levelMhz(uint8_t index) { return LEVEL_MHZ[index]; }
+    float getLoad() const { return last_load; }
+
+    // Control side: residency since the previous call, then resets it
+    Residency readResidency();
+
+private:
+    void applyLevel(uint8_t next);
+};
+
+#endif // POWERMANAGER_H
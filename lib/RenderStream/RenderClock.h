@@ -0,0 +1,24 @@
+#ifndef RENDERCLOCK_H
+#define RENDERCLOCK_H
+
+#include "Arduino.h"
+
+// Sample clock driven by RenderStream. The render loop fires the events due
+// now, renders up to the next one, then advances the clock: events land on
+// their exact sample without any extra timer.
+class RenderClock
+{
+public:
+    virtual ~RenderClock() {}
+
+    // Fire every event due at the current sample
+    virtual void processEvents() = 0;
+
+    // Frames that can be rendered before the next event (>= 1)
+    virtual uint32_t framesUntilNextEvent() const = 0;
+
+    // Move the clock forward after rendering
+    virtual void advance(uint32_t frames) = 0;
+};
+
+#endif // RENDERCLOCK_H
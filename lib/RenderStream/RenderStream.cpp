@@ -0,0 +1,339 @@
+#include <RenderStream.h>
+
+RenderStream::RenderStream()
+    : out_info(defaultAudioInfo()), num_voices(0), clock(nullptr), reverb(nullptr), master(nullptr), detector(nullptr), recorder(nullptr),
+      reverb_idle_frames(0), total_frames(0), silent_frames(0), busy_us(0), busy_frames(0),
+      dual_core(false), worker_num_voices(0), worker_samples(0), worker_fallbacks(0),
+      pipelined(false), pipeline_time(0), reverb_input_frames(0), reverb_input_time(0)
+{
+    memset(voices, 0, sizeof(voices));
+    memset(worker_voices, 0, sizeof(worker_voices));
+    memset(wet_ring, 0, sizeof(wet_ring));
+}
+
+bool RenderStream::begin(audio_tools::AudioInfo audioInfo)
+{
+    out_info = audioInfo;
+    if (out_info.channels > MAX_CHANNELS || out_info.bits_per_sample != 16)
+    {
+        LOG_PRINTLN("Error: RenderStream supports 16-bit mono/stereo only");
+        return false;
+    }
+    return true;
+}
+
+bool RenderStream::addVoice(Voice *voice)
+{
+    if (!voice || num_voices >= MAX_VOICES)
+    {
+        return false;
+    }
+    voices[num_voices++] = voice;
+    return true;
+}
+
+float RenderStream::readSilentPercent()
+{
+    // Counters written by the audio task: a stale pair only blurs one reading
+    uint32_t total = total_frames;
+    uint32_t silent = silent_frames;
+    total_frames = 0;
+    silent_frames = 0;
+    return total ? silent * 100.0f / total : 0.0f;
+}
+
+bool RenderStream::setDualCore(bool enable)
+{
+    // Same priority as the audio task, on the core it does not use
+    if (enable && !worker.start(workerJob, this, "RenderWorker", 0, 3))
+    {
+        LOG_PRINTLN("⚠️ RenderStream: no render worker, staying on one core");
+        return false;
+    }
+    dual_core = enable;
+    LOG_PRINTF("🧵 Render: %s\n", enable ? "dual core (voices + reverb on a Core 0 worker)" : "single core");
+    return true;
+}
+
+void RenderStream::workerJob(void *context)
+{
+    RenderStream *self = (RenderStream *)context;
+    self->runPendingReverb();
+    mixVoices(self->worker_voices, self->worker_num_voices,
+              self->worker_scratch, self->worker_accumulator, self->worker_samples);
+}
+
+void RenderStream::runPendingReverb()
+{
+    if (!reverb_input_frames)
+    {
+        return;
+    }
+
+    // Wet part of the previous slice, written where it will be played
+    uint8_t channels = out_info.channels;
+    uint32_t frames = reverb_input_frames;
+    uint32_t pos = (reverb_input_time + REVERB_LATENCY) % WET_RING_FRAMES;
+    uint32_t first = min(frames, WET_RING_FRAMES - pos);
+    reverb->processWet(reverb_input, wet_ring + pos * channels, first, channels);
+    if (first < frames)
+    {
+        reverb->processWet(reverb_input + first * channels, wet_ring, frames - first, channels);
+    }
+    reverb_input_frames = 0;
+}
+
+void RenderStream::addWet(int32_t *sum, uint32_t frames)
+{
+    // Each ring slot is played once, then cleared for the next lap
+    uint8_t channels = out_info.channels;
+    uint32_t pos = pipeline_time % WET_RING_FRAMES;
+    uint32_t first = min(frames, WET_RING_FRAMES - pos);
+    DSPKernels::accumulate(sum, wet_ring + pos * channels, first * channels);
+    memset(wet_ring + pos * channels, 0, first * channels * sizeof(int32_t));
+    if (first < frames)
+    {
+        DSPKernels::accumulate(sum + first * channels, wet_ring, (frames - first) * channels);
+        memset(wet_ring, 0, (frames - first) * channels * sizeof(int32_t));
+    }
+    pipeline_time += frames;
+}
+
+void RenderStream::skipPipeline(uint32_t frames)
+{
+    // Reverb tail over: nothing pending, the skipped slots are dropped
+    reverb_input_frames = 0;
+    uint8_t channels = out_info.channels;
+    if (frames >= WET_RING_FRAMES)
+    {
+        memset(wet_ring, 0, sizeof(wet_ring));
+    }
+    else
+    {
+        uint32_t pos = pipeline_time % WET_RING_FRAMES;
+        uint32_t first = min(frames, WET_RING_FRAMES - pos);
+        memset(wet_ring + pos * channels, 0, first * channels * sizeof(int32_t));
+        memset(wet_ring, 0, (frames - first) * channels * sizeof(int32_t));
+    }
+    pipeline_time += frames;
+}
+
+void RenderStream::resetPipeline()
+{
+    reverb_input_frames = 0;
+    memset(wet_ring, 0, sizeof(wet_ring));
+}
+
+void RenderStream::mixVoices(Voice *const *list, uint8_t count, int16_t *buffer, int32_t *sum, uint32_t samples)
+{
+    memset(sum, 0, samples * sizeof(int32_t));
+
+    // 32-bit sum so voices never wrap around before the final clamp
+    for (uint8_t v = 0; v < count; v++)
+    {
+        size_t got = list[v]->getAudioStream()->readBytes((uint8_t *)buffer, samples * sizeof(int16_t)) / sizeof(int16_t);
+        DSPKernels::mixAccumulate(sum, buffer, got);
+    }
+}
+
+void RenderStream::takeRenderTime(uint32_t &us, uint32_t &frames)
+{
+    us = busy_us;
+    frames = busy_frames;
+    busy_us = 0;
+    busy_frames = 0;
+}
+
+size_t RenderStream::readBytes(uint8_t *data, size_t len)
+{
+    uint32_t start_us = micros();
+    int16_t *out = (int16_t *)data;
+    uint8_t channels = out_info.channels;
+    uint32_t frames = len / (sizeof(int16_t) * channels);
+    uint32_t frame = 0;
+
+    while (frame < frames)
+    {
+        // Events due now (note on, gate off) land on this exact sample
+        uint32_t count = frames - frame;
+        if (clock)
+        {
+            clock->processEvents();
+            count = min(count, clock->framesUntilNextEvent());
+        }
+
+        renderVoices(out + frame * channels, count);
+
+        if (clock)
+        {
+            clock->advance(count);
+        }
+        frame += count;
+    }
+
+    // Both see exactly what goes to the DAC
+    if (detector)
+    {
+        detector->process((const int16_t *)data, frames);
+    }
+    if (recorder)
+    {
+        recorder->write((const int16_t *)data, frames);
+    }
+
+    busy_us += micros() - start_us;
+    busy_frames += frames;
+    return frames * channels * sizeof(int16_t);
+}
+
+void RenderStream::renderVoices(int16_t *out, uint32_t frames)
+{
+    uint8_t channels = out_info.channels;
+    total_frames += frames;
+
+    // Which voices are sounding: the others are skipped entirely
+    Voice *active[MAX_VOICES];
+    uint8_t num_active = 0;
+    for (uint8_t v = 0; v < num_voices; v++)
+    {
+        if (voices[v]->isActive())
+        {
+            active[num_active++] = voices[v];
+        }
+    }
+
+    // The reverb keeps running until its tail is gone
+    bool reverb_on = reverb && reverb->isActive();
+    if (reverb_on)
+    {
+        if (num_active > 0)
+        {
+            reverb_idle_frames = 0;
+        }
+        else if (reverb_idle_frames > reverb->tailFrames())
+        {
+            reverb_on = false;
+        }
+        else
+        {
+            reverb_idle_frames += frames;
+            if (reverb_idle_frames > reverb->tailFrames())
+            {
+                reverb->clear();
+            }
+        }
+    }
+
+    // Dual core with a reverb: it runs one slice behind on the worker
+    bool pipeline = dual_core && reverb;
+    if (pipeline != pipelined)
+    {
+        resetPipeline();
+        pipelined = pipeline;
+    }
+
+    // All silent: zero-fill, nothing else to compute
+    if (num_active == 0 && !reverb_on)
+    {
+        if (pipelined)
+        {
+            skipPipeline(frames);
+        }
+        memset(out, 0, frames * channels * sizeof(int16_t));
+        silent_frames += frames;
+        if (master)
+        {
+            master->addSilence(frames * channels);
+        }
+        return;
+    }
+
+    // One dry voice, no bus processing: read straight into the output
+    if (num_active == 1 && !master && !reverb_on)
+    {
+        size_t bytes = frames * channels * sizeof(int16_t);
+        size_t got = active[0]->getAudioStream()->readBytes((uint8_t *)out, bytes);
+        if (got < bytes)
+        {
+            memset((uint8_t *)out + got, 0, bytes - got);
+        }
+        if (pipelined)
+        {
+            skipPipeline(frames);
+        }
+        return;
+    }
+
+    while (frames > 0)
+    {
+        uint32_t n = min(frames, (uint32_t)SCRATCH_FRAMES);
+        uint32_t samples = n * channels;
+
+        // The worker gets the pending reverb, so one voice is enough to split
+        if (dual_core && (num_active >= 2 || pipelined) && n >= MIN_SPLIT_FRAMES)
+        {
+            // Deal the voices: odd ones to Core 0, even ones stay here
+            Voice *local[MAX_VOICES];
+            uint8_t num_local = 0;
+            worker_num_voices = 0;
+            for (uint8_t v = 0; v < num_active; v++)
+            {
+                if (v & 1)
+                {
+                    worker_voices[worker_num_voices++] = active[v];
+                }
+                else
+                {
+                    local[num_local++] = active[v];
+                }
+            }
+            worker_samples = samples;
+
+            worker.kick();
+            mixVoices(local, num_local, scratch, accumulator, samples);
+            if (!worker.wait(WORKER_TIMEOUT_US))
+            {
+                worker_fallbacks = worker_fallbacks + 1;
+            }
+
+            DSPKernels::accumulate(accumulator, worker_accumulator, samples);
+        }
+        else
+        {
+            if (pipelined)
+            {
+                runPendingReverb();
+            }
+            mixVoices(active, num_active, scratch, accumulator, samples);
+        }
+
+        if (pipelined)
+        {
+            // Dry sum for the reverb on the next slice, then the wet part
+            // computed from REVERB_LATENCY frames ago
+            if (reverb_on)
+            {
+                memcpy(reverb_input, accumulator, samples * sizeof(int32_t));
+                reverb_input_frames = n;
+                reverb_input_time = pipeline_time;
+            }
+            addWet(accumulator, n);
+        }
+        else if (reverb_on)
+        {
+            reverb->process(accumulator, n, channels);
+        }
+
+        if (master)
+        {
+            master->process(accumulator, out, samples);
+        }
+        else
+        {
+            DSPKernels::saturate16(accumulator, out, samples);
+        }
+
+        out += samples;
+        frames -= n;
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef RENDERSTREAM_H
+#define RENDERSTREAM_H
+
+#include "Arduino.h"
+#include "AudioTools.h"
+#include <AudioConfig.h>
+#include <AsyncLog.h>
+#include <RenderClock.h>
+#include <Reverb.h>
+#include <MasterBus.h>
+#include <GlitchDetector.h>
+#include <WavRecorder.h>
+#include <Voice.h>
+#include <RenderWorker.h>
+#include <DSPKernels.h>
+
+// Final audio stream read by the I2S copier.
+//
+// Sums the voice streams and splits every block at the events of the
+// RenderClock (the sequencer), so notes start on their exact sample
+// whatever the copier block size. The shared reverb runs on the 32-bit
+// sum, then the master bus soft-clips it down to 16 bits.
+//
+// Voices whose envelope is idle are not read at all. When none is active
+// and the reverb tail has died, the block is a plain zero-fill.
+//
+// Dual-core mode: the active voices are dealt between the audio task and
+// a worker on Core 0, each summing its share into its own accumulator;
+// the two meet at a barrier per slice. The reverb moves to the worker
+// too, one slice behind: it reads the dry sum of the previous slice and
+// writes its wet part into a ring REVERB_LATENCY frames ahead, so the wet
+// signal gets a fixed pre-delay (5.8 ms at 44.1 kHz) and Core 0 has work
+// even when a single voice plays. The master bus stays on the audio task.
+// A voice (with its envelope and filter) and the reverb are only ever
+// touched by one core per slice.
+class RenderStream : public audio_tools::AudioStream
+{
+public:
+    static const uint8_t MAX_VOICES = 8;
+    static const uint16_t MIN_SPLIT_FRAMES = 32; // shorter slices stay on one core
+    static const uint32_t WORKER_TIMEOUT_US = 200; // then Core 1 renders the worker's share
+    static const uint16_t SCRATCH_FRAMES = 256;
+    static const uint8_t MAX_CHANNELS = 2;
+    static const uint16_t REVERB_LATENCY = SCRATCH_FRAMES; // dual core: wet pre-delay, at least one slice
+    static const uint16_t WET_RING_FRAMES = 2 * REVERB_LATENCY;
+
+private:
+    audio_tools::AudioInfo out_info;
+    Voice *voices[MAX_VOICES];
+    uint8_t num_voices;
+    RenderClock *clock;
+    Reverb *reverb;
+    MasterBus *master;
+    GlitchDetector *detector;
+    WavRecorder *recorder;
+    uint32_t reverb_idle_frames; // since the last active voice
+
+    // Statistics (read from loop())
+    volatile uint32_t total_frames;
+    volatile uint32_t silent_frames;
+
+    // DSP time, taken by the audio task after each copy
+    uint32_t busy_us;
+    uint32_t busy_frames;
+
+    int16_t scratch[SCRATCH_FRAMES * MAX_CHANNELS];
+    int32_t accumulator[SCRATCH_FRAMES * MAX_CHANNELS];
+
+    // Core 0 share of the current slice
+    RenderWorker worker;
+    volatile bool dual_core;
+    Voice *worker_voices[MAX_VOICES];
+    uint8_t worker_num_voices;
+    uint32_t worker_samples;
+    int16_t worker_scratch[SCRATCH_FRAMES * MAX_CHANNELS];
+    int32_t worker_accumulator[SCRATCH_FRAMES * MAX_CHANNELS];
+    volatile uint32_t worker_fallbacks;
+
+    // Dual-core reverb: dry sum of the previous slice, wet ring indexed by
+    // the frame count
+    bool pipelined;
+    uint32_t pipeline_time;
+    uint32_t reverb_input_frames;
+    uint32_t reverb_input_time;
+    int32_t reverb_input[SCRATCH_FRAMES * MAX_CHANNELS];
+    int32_t wet_ring[WET_RING_FRAMES * MAX_CHANNELS];
+
+public:
+    RenderStream();
+
+    bool begin(audio_tools::AudioInfo audioInfo);
+    bool addVoice(Voice *voice);
+    void setClock(RenderClock *renderClock) { clock = renderClock; }
+    void setReverb(Reverb *bus_reverb) { reverb = bus_reverb; }
+    void setMasterBus(MasterBus *bus) { master = bus; }
+    void setGlitchDetector(GlitchDetector *glitchDetector) { detector = glitchDetector; }
+    void setRecorder(WavRecorder *wavRecorder) { recorder = wavRecorder; }
+    uint8_t getNumVoices() const { return num_voices; }
+
+    // Optional second render core (worker task created on first enable)
+    bool setDualCore(bool enable);
+    bool isDualCore() const { return dual_core; }
+    uint32_t getWorkerFallbacks() const { return worker_fallbacks; } // slices the worker missed
+
+    // Share of the frames rendered as zero-fill since the last call (0-100)
+    float readSilentPercent();
+
+    // Audio task: time spent in readBytes() and frames rendered since the
+    // previous call
+    void takeRenderTime(uint32_t &us, uint32_t &frames);
+
+    // AudioStream
+    size_t readBytes(uint8_t *data, size_t len) override;
+    size_t write(const uint8_t *data, size_t len) override { return 0; }
+    int available() override { return DEFAULT_BUFFER_SIZE; }
+
+private:
+    void renderVoices(int16_t *out, uint32_t frames);
+    static void mixVoices(Voice *const *list, uint8_t count, int16_t *buffer, int32_t *sum, uint32_t samples);
+    static void workerJob(void *context);
+    void runPendingReverb();
+    void addWet(int32_t *sum, uint32_t frames);
+    void skipPipeline(uint32_t frames);
+    void resetPipeline();
+};
+
+#endif // RENDERSTREAM_H
@@ -0,0 +1,156 @@
+#ifndef RENDERWORKER_H
+#define RENDERWORKER_H
+
+#include "Arduino.h"
+#include <atomic>
+#ifndef ESP_PLATFORM
+#include <thread>
+#endif
+
+// Second render thread with a per-block barrier.
+//
+// The audio task kick()s a job, does its own share of the block, then
+// wait()s: a spin on a sequence number, no kernel call on the way back.
+// Each job is claimed once, by whichever side gets there first: if the
+// worker has not picked it up within the timeout (its core is busy with
+// something of higher priority), the audio task runs it itself instead
+// of spinning on.
+// On the ESP32 the worker is a FreeRTOS task pinned to the other core and
+// woken by a task notification; on the host it is a std::thread, so the
+// same render code runs with two threads there.
+class RenderWorker
+{
+public:
+    typedef void (*Job)(void *context);
+
+private:
+    Job job;
+    void *context;
+    std::atomic<uint32_t> requested;
+    std::atomic<uint32_t> claimed;
+    std::atomic<uint32_t> completed;
+#ifdef ESP_PLATFORM
+    TaskHandle_t task;
+#else
+    std::thread thread;
+    std::atomic<bool> running;
+#endif
+
+public:
+    RenderWorker()
+        : job(nullptr), context(nullptr), requested(0), claimed(0), completed(0)
+#ifdef ESP_PLATFORM
+          , task(NULL)
+#else
+          , running(false)
+#endif
+    {
+    }
+
+    ~RenderWorker()
+    {
+#ifndef ESP_PLATFORM
+        if (running)
+        {
+            running = false;
+            thread.join();
+        }
+#endif
+    }
+
+    bool start(Job workerJob, void *jobContext, const char *name, uint8_t core, uint8_t priority)
+    {
+        if (isRunning())
+        {
+            return true;
+        }
+        job = workerJob;
+        context = jobContext;
+#ifdef ESP_PLATFORM
+        xTaskCreatePinnedToCore(workerTask, name, 4096, this, priority, &task, core);
+#else
+        running = true;
+        thread = std::thread(workerThread, this);
+#endif
+        return isRunning();
+    }
+
+    bool isRunning() const
+    {
+#ifdef ESP_PLATFORM
+        return task != NULL;
+#else
+        return running;
+#endif
+    }
+
+    // Audio task: start the worker's share of the block
+    void kick()
+    {
+        requested.fetch_add(1, std::memory_order_release);
+#ifdef ESP_PLATFORM
+        xTaskNotifyGive(task);
+#endif
+    }
+
+    // Audio task: barrier, returns once the worker's share is done. False
+    // when the worker had not started it after timeout_us and it was run
+    // here instead
+    bool wait(uint32_t timeout_us)
+    {
+        uint32_t target = requested.load(std::memory_order_relaxed);
+        uint32_t start = micros();
+        while (completed.load(std::memory_order_acquire) != target)
+        {
+            if (micros() - start > timeout_us && claim(target))
+            {
+                job(context);
+                completed.store(target, std::memory_order_release);
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    // Once per job: the loser leaves it to the other side
+    bool claim(uint32_t target)
+    {
+        uint32_t previous = claimed.load(std::memory_order_relaxed);
+        return previous != target &&
+               claimed.compare_exchange_strong(previous, target, std::memory_order_acquire);
+    }
+
+    void runPending()
+    {
+        uint32_t target = requested.load(std::memory_order_acquire);
+        if (claim(target))
+        {
+            job(context);
+            completed.store(target, std::memory_order_release);
+        }
+    }
+
+#ifdef ESP_PLATFORM
+    static void workerTask(void *parameter)
+    {
+        RenderWorker *worker = (RenderWorker *)parameter;
+        while (true)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            worker->runPending();
+        }
+    }
+#else
+    static void workerThread(RenderWorker *worker)
+    {
+        while (worker->running)
+        {
+            worker->runPending();
+            std::this_thread::yield();
+        }
+    }
+#endif
+};
+
+#endif // RENDERWORKER_H
@@ -0,0 +1,227 @@
+#include <Reverb.h>
+
+// Mutually prime line lengths at 44.1 kHz (20 to 43 ms): no common echoes
+static const uint16_t base_lengths[Reverb::MAX_LINES] = {887, 1031, 1171, 1319, 1453, 1601, 1747, 1889};
+
+Reverb::Reverb()
+    : pool(nullptr), pool_in_psram(false), sample_rate(AUDIO_SAMPLE_RATE), num_lines(0), mix_shift(0),
+      damp_q15(0), wet_q15(0), pending_lines(4), pending_gains(true),
+      decay_seconds(4.0f), damping(0.4f), mix(0.25f)
+{
+    memset(lines, 0, sizeof(lines));
+    memset(lengths, 0, sizeof(lengths));
+    memset(positions, 0, sizeof(positions));
+    memset(lowpass, 0, sizeof(lowpass));
+    memset(gain_q15, 0, sizeof(gain_q15));
+}
+
+Reverb::~Reverb()
+{
+    if (pool)
+    {
+        free(pool);
+    }
+}
+
+bool Reverb::begin(uint32_t rate)
+{
+    sample_rate = rate;
+
+    if (!pool)
+    {
+        // One allocation for the lifetime of the synth
+        pool_in_psram = psramFound();
+        pool = (int16_t *)(pool_in_psram ? ps_malloc(POOL_SAMPLES * sizeof(int16_t))
+                                         : malloc(POOL_SAMPLES * sizeof(int16_t)));
+        if (!pool)
+        {
+            LOG_PRINTLN("⚠️ Reverb: no memory for the delay lines");
+            return false;
+        }
+        LOG_PRINTF("🌫️ Reverb pool: %lu KB in %s\n",
+                   (unsigned long)(POOL_SAMPLES * sizeof(int16_t) / 1024), pool_in_psram ? "PSRAM" : "RAM");
+    }
+
+    pending_lines = pending_lines ? pending_lines : 4;
+    return true;
+}
+
+void Reverb::setLines(uint8_t count)
+{
+    pending_lines = count >= 8 ? 8 : count >= 4 ? 4 : 2;
+}
+
+void Reverb::setDecay(float seconds)
+{
+    decay_seconds = constrain(seconds, 0.1f, 30.0f);
+    pending_gains = true;
+}
+
+void Reverb::setDamping(float amount)
+{
+    damping = constrain(amount, 0.0f, 1.0f);
+    pending_gains = true;
+}
+
+void Reverb::setMix(float wet)
+{
+    mix = constrain(wet, 0.0f, 1.0f);
+    pending_gains = true;
+}
+
+void Reverb::clear()
+{
+    // Called once the tail has died: drop what is left of it (a few LSB)
+    if (pool && num_lines)
+    {
+        int16_t *end = lines[num_lines - 1] + lengths[num_lines - 1];
+        memset(pool, 0, (end - pool) * sizeof(int16_t));
+        memset(lowpass, 0, sizeof(lowpass));
+    }
+}
+
+void Reverb::configureLines(uint8_t count)
+{
+    num_lines = count;
+    mix_shift = count == 8 ? 2 : count == 4 ? 1 : 0;
+
+    // Scale the lengths to the sample rate, shrink them if the pool is short
+    float scale = sample_rate / 44100.0f;
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        total += base_lengths[i] * scale;
+    }
+    if (total > POOL_SAMPLES)
+    {
+        scale *= (float)POOL_SAMPLES / total;
+    }
+
+    int16_t *next = pool;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        lengths[i] = max((uint16_t)(base_lengths[i] * scale), (uint16_t)16);
+        lines[i] = next;
+        positions[i] = 0;
+        lowpass[i] = 0;
+        next += lengths[i];
+    }
+    memset(pool, 0, (next - pool) * sizeof(int16_t));
+
+    updateGains();
+}
+
+void Reverb::updateGains()
+{
+    // Each pass through line i loses 60 dB over decay_seconds
+    for (uint8_t i = 0; i < num_lines; i++)
+    {
+        float gain = powf(10.0f, -3.0f * lengths[i] / (sample_rate * decay_seconds));
+        gain_q15[i] = (int32_t)(gain * 32767);
+    }
+
+    damp_q15 = (int32_t)((1.0f - 0.9f * damping) * 32767);
+    wet_q15 = (int32_t)(mix * 32767);
+}
+
+void Reverb::process(int32_t *buffer, uint32_t frames, uint8_t channels)
+{
+    if (applyPending())
+    {
+        render(buffer, buffer, frames, channels, true);
+    }
+}
+
+void Reverb::processWet(const int32_t *input, int32_t *wet, uint32_t frames, uint8_t channels)
+{
+    if (applyPending())
+    {
+        render(input, wet, frames, channels, false);
+    }
+    else
+    {
+        memset(wet, 0, frames * channels * sizeof(int32_t));
+    }
+}
+
+bool Reverb::applyPending()
+{
+    if (!pool)
+    {
+        return false;
+    }
+
+    // Settings changed from another task are applied between blocks
+    if (pending_lines != num_lines)
+    {
+        configureLines(pending_lines);
+        pending_gains = false;
+    }
+    else if (pending_gains)
+    {
+        pending_gains = false;
+        updateGains();
+    }
+
+    return wet_q15 != 0;
+}
+
+void Reverb::render(const int32_t *input, int32_t *output, uint32_t frames, uint8_t channels, bool add)
+{
+    int32_t taps[MAX_LINES];
+    for (uint32_t f = 0; f < frames; f++)
+    {
+        const int32_t *frame = input + f * channels;
+        int32_t *target = output + f * channels;
+
+        // Mono input with headroom for the feedback
+        int32_t in = channels > 1 ? (frame[0] + frame[1]) >> 2 : frame[0] >> 1;
+
+        int32_t sum = 0;
+        for (uint8_t i = 0; i < num_lines; i++)
+        {
+            taps[i] = lines[i][positions[i]];
+            sum += taps[i];
+        }
+        int32_t reflected = sum >> mix_shift;
+
+        int32_t left = 0;
+        int32_t right = 0;
+        for (uint8_t i = 0; i < num_lines; i++)
+        {
+            // Householder feedback: lossless mixing with one subtraction
+            // (saturated to 16 bits so the Q15 products below fit in 32)
+            int32_t feedback = constrain(taps[i] - reflected, -32768, 32767);
+            lowpass[i] += ((feedback - lowpass[i]) * damp_q15) >> 15;
+
+            int32_t value = ((lowpass[i] * gain_q15[i]) >> 15) + in;
+            lines[i][positions[i]] = constrain(value, -32768, 32767);
+            if (++positions[i] >= lengths[i])
+            {
+                positions[i] = 0;
+            }
+
+            // Even lines left, odd lines right: decorrelated stereo
+            if (i & 1)
+            {
+                right += taps[i];
+            }
+            else
+            {
+                left += taps[i];
+            }
+        }
+
+        left = ((left >> mix_shift) * wet_q15) >> 15;
+        right = ((right >> mix_shift) * wet_q15) >> 15;
+        if (channels > 1)
+        {
+            target[0] = (add ? target[0] : 0) + left;
+            target[1] = (add ? target[1] : 0) + right;
+        }
+        else
+        {
+            target[0] = (add ? target[0] : 0) + ((left + right) >> 1);
+        }
+    }
+}
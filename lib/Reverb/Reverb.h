@@ -0,0 +1,77 @@
+#ifndef REVERB_H
+#define REVERB_H
+
+#include "Arduino.h"
+#include <AudioConfig.h>
+#include <AsyncLog.h>
+
+// Feedback delay network reverb, mono in / stereo out.
+//
+// 2, 4 or 8 integer delay lines carved out of one pool allocated once in
+// begin() (PSRAM when present). Lines are mixed through a Householder
+// matrix (one sum and a shift), damped by a one-pole lowpass and scaled
+// for the requested decay time. The number of lines is the CPU-cost knob:
+// every line costs the same few integer operations per sample.
+class Reverb
+{
+public:
+    static const uint8_t MAX_LINES = 8;
+    static const uint32_t POOL_SAMPLES = 16384; // 32 KB
+    static const uint16_t MAX_LINE_LENGTH = 1889; // longest line at 44.1 kHz
+
+private:
+    int16_t *pool;
+    bool pool_in_psram;
+    uint32_t sample_rate;
+
+    // Active configuration (audio side)
+    uint8_t num_lines;
+    uint8_t mix_shift; // log2(num_lines) - 1
+    int16_t *lines[MAX_LINES];
+    uint16_t lengths[MAX_LINES];
+    uint16_t positions[MAX_LINES];
+    int32_t lowpass[MAX_LINES];
+    int32_t gain_q15[MAX_LINES];
+    int32_t damp_q15;
+    int32_t wet_q15;
+
+    // Settings, picked up by the audio side on the next block
+    volatile uint8_t pending_lines;
+    volatile bool pending_gains;
+    float decay_seconds;
+    float damping;
+    float mix;
+
+public:
+    Reverb();
+    ~Reverb();
+
+    bool begin(uint32_t rate);
+
+    void setLines(uint8_t count); // 2, 4 or 8
+    void setDecay(float seconds);
+    void setDamping(float amount); // 0 = bright, 1 = dark
+    void setMix(float wet);
+
+    uint8_t getLines() const { return num_lines; }
+    float getDecay() const { return decay_seconds; }
+    float getMix() const { return mix; }
+    bool isActive() const { return pool && mix > 0.0f; }
+
+    // Frames after the last input before the tail is below -60 dB
+    uint32_t tailFrames() const { return (uint32_t)(decay_seconds * sample_rate) + 2 * MAX_LINE_LENGTH; }
+    void clear();
+
+    // Adds the wet signal to a 32-bit interleaved buffer, in place
+    void process(int32_t *buffer, uint32_t frames, uint8_t channels);
+    // Writes the wet signal of input alone (the dry sum stays elsewhere)
+    void processWet(const int32_t *input, int32_t *wet, uint32_t frames, uint8_t channels);
+
+private:
+    bool applyPending();
+    void render(const int32_t *input, int32_t *output, uint32_t frames, uint8_t channels, bool add);
+    void configureLines(uint8_t count);
+    void updateGains();
+};
+
+#endif // REVERB_H
@@ -0,0 +1,88 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include "Arduino.h"
+
+// Lock-free single-producer / single-consumer ring buffer.
+//
+// One task writes, one task reads, neither ever blocks. Counters run freely
+// and are masked on access, so SIZE must be a power of two. The region
+// accessors give direct pointers into the storage for zero-copy reads and
+// writes (e.g. File::read() straight into the ring).
+template <typename T, uint32_t SIZE>
+class SPSCRing
+{
+    static_assert((SIZE & (SIZE - 1)) == 0, "SPSCRing SIZE must be a power of two");
+
+private:
+    T buffer[SIZE];
+    volatile uint32_t write_count;
+    volatile uint32_t read_count;
+
+public:
+    SPSCRing() : write_count(0), read_count(0) {}
+
+    // Only safe while neither side is touching the ring
+    void reset()
+    {
+        write_count = 0;
+        read_count = 0;
+    }
+
+    uint32_t capacity() const { return SIZE; }
+    uint32_t readable() const { return write_count - read_count; }
+    uint32_t writable() const { return SIZE - (write_count - read_count); }
+
+    // Producer side: contiguous free space starting at the write position
+    T *writeRegion(uint32_t &count)
+    {
+        uint32_t index = write_count & (SIZE - 1);
+        count = min(writable(), SIZE - index);
+        return &buffer[index];
+    }
+
+    void commitWrite(uint32_t count)
+    {
+        __sync_synchronize(); // data visible before the counter moves
+        write_count = write_count + count;
+    }
+
+    // Consumer side: contiguous data starting at the read position
+    const T *readRegion(uint32_t &count) const
+    {
+        uint32_t index = read_count & (SIZE - 1);
+        count = min(readable(), SIZE - index);
+        return &buffer[index];
+    }
+
+    void commitRead(uint32_t count)
+    {
+        __sync_synchronize();
+        read_count = read_count + count;
+    }
+
+    // Single element helpers
+    bool push(const T &value)
+    {
+        if (writable() == 0)
+        {
+            return false;
+        }
+        buffer[write_count & (SIZE - 1)] = value;
+        commitWrite(1);
+        return true;
+    }
+
+    bool pop(T &value)
+    {
+        if (readable() == 0)
+        {
+            return false;
+        }
+        value = buffer[read_count & (SIZE - 1)];
+        commitRead(1);
+        return true;
+    }
+};
+
+#endif // SPSCRING_H
@@ -0,0 +1,180 @@
+#include <SVFilter.h>
+
+// ln(1000): the envelope decay time is a 60 dB fall, like the bowl T60s
+static const float LN_1000 = 6.9078f;
+static const float MIN_CUTOFF = 20.0f;
+
+SVFilter::SVFilter()
+    : input(nullptr), info(defaultAudioInfo()), enabled(false), mode(LOWPASS),
+      cutoff_octaves(4.0f), resonance(0.5f), env_octaves(3.0f), decay_seconds(0.3f),
+      accent_octaves(1.5f), accent_decay(0.15f),
+      env(0), env_depth(0), env_coef(0), next_accent(false)
+{
+    memset(g_table, 0, sizeof(g_table));
+    memset(ic1, 0, sizeof(ic1));
+    memset(ic2, 0, sizeof(ic2));
+}
+
+bool SVFilter::begin(audio_tools::AudioInfo audioInfo)
+{
+    info = audioInfo;
+    if (info.bits_per_sample != 16 || info.channels > MAX_CHANNELS)
+    {
+        LOG_PRINTLN("Error: SVFilter supports 16-bit mono/stereo only");
+        return false;
+    }
+    buildTable();
+    return true;
+}
+
+void SVFilter::buildTable()
+{
+    // The only tan() calls: once per entry, once per sample rate
+    float nyquist_guard = 0.45f * info.sample_rate;
+    for (uint16_t i = 0; i <= TABLE_SIZE; i++)
+    {
+        float hz = MIN_CUTOFF * powf(2.0f, (float)i * OCTAVE_RANGE / TABLE_SIZE);
+        hz = min(hz, nyquist_guard);
+        g_table[i] = tanf(PI * hz / info.sample_rate);
+    }
+}
+
+float SVFilter::lookupG(float octaves) const
+{
+    float pos = constrain(octaves, 0.0f, (float)OCTAVE_RANGE) * TABLE_SIZE / OCTAVE_RANGE;
+    uint16_t index = (uint16_t)pos;
+    if (index >= TABLE_SIZE)
+    {
+        index = TABLE_SIZE - 1;
+    }
+    float frac = pos - index;
+    return g_table[index] + (g_table[index + 1] - g_table[index]) * frac;
+}
+
+void SVFilter::setEnabled(bool enable)
+{
+    enabled = enable;
+}
+
+void SVFilter::setCutoff(float hz)
+{
+    cutoff_octaves = log2f(max(hz, MIN_CUTOFF) / MIN_CUTOFF);
+}
+
+float SVFilter::getCutoff() const
+{
+    return MIN_CUTOFF * powf(2.0f, cutoff_octaves);
+}
+
+void SVFilter::setResonance(float amount)
+{
+    resonance = constrain(amount, 0.0f, 1.0f);
+}
+
+void SVFilter::setEnvelope(float octaves, float decay)
+{
+    env_octaves = constrain(octaves, -(float)OCTAVE_RANGE, (float)OCTAVE_RANGE);
+    decay_seconds = constrain(decay, 0.01f, 10.0f);
+}
+
+void SVFilter::setAccent(float octaves, float decay)
+{
+    accent_octaves = constrain(octaves, 0.0f, (float)OCTAVE_RANGE);
+    accent_decay = constrain(decay, 0.01f, 10.0f);
+}
+
+void SVFilter::trigger(float velocity)
+{
+    // Accent: deeper, snappier sweep on top of the velocity-scaled one
+    float decay = decay_seconds;
+    env_depth = env_octaves * constrain(velocity, 0.0f, 1.0f);
+    if (next_accent)
+    {
+        env_depth += accent_octaves;
+        decay = min(decay, accent_decay);
+        next_accent = false;
+    }
+    env_coef = expf(-LN_1000 * SUB_BLOCK / (decay * info.sample_rate));
+    env = 1.0f;
+}
+
+void SVFilter::process(int16_t *samples, uint32_t frames, uint8_t channels)
+{
+    // Damping 2 (flat) down to 0.04 (ringing), kept clear of self-oscillation
+    float k = 2.0f - 1.96f * resonance;
+    // The resonant peak adds up to ~6 dB: trim the input as resonance rises
+    float drive = 0.5f + 0.25f * k;
+    Mode active_mode = mode;
+
+    for (uint32_t start = 0; start < frames; start += SUB_BLOCK)
+    {
+        uint32_t count = min(frames - start, (uint32_t)SUB_BLOCK);
+
+        // One table lookup and one division per sub-block
+        float g = lookupG(cutoff_octaves + env_depth * env);
+        float a1 = 1.0f / (1.0f + g * (g + k));
+        float a2 = g * a1;
+        float a3 = g * a2;
+        env *= env_coef;
+
+        for (uint8_t c = 0; c < channels; c++)
+        {
+            float s1 = ic1[c];
+            float s2 = ic2[c];
+            int16_t *sample = samples + start * channels + c;
+
+            for (uint32_t n = 0; n < count; n++, sample += channels)
+            {
+                float v0 = *sample * drive;
+                float v3 = v0 - s2;
+                float v1 = a1 * s1 + a2 * v3;
+                float v2 = s2 + a2 * s1 + a3 * v3;
+                s1 = 2.0f * v1 - s1;
+                s2 = 2.0f * v2 - s2;
+
+                float out = active_mode == LOWPASS    ? v2
+                            : active_mode == BANDPASS ? v1
+                                                      : v0 - k * v1 - v2;
+                *sample = (int16_t)constrain((int32_t)out, -32768, 32767);
+            }
+
+            ic1[c] = s1;
+            ic2[c] = s2;
+        }
+    }
+
+    // Flush the tails before they turn denormal
+    for (uint8_t c = 0; c < channels; c++)
+    {
+        if (fabsf(ic1[c]) < 1e-6f && fabsf(ic2[c]) < 1e-6f)
+        {
+            ic1[c] = 0;
+            ic2[c] = 0;
+        }
+    }
+}
+
+size_t SVFilter::readBytes(uint8_t *data, size_t len)
+{
+    if (!input)
+    {
+        memset(data, 0, len);
+        return len;
+    }
+
+    size_t bytes = input->readBytes(data, len);
+
+    if (enabled)
+    {
+        uint8_t channels = info.channels;
+        process((int16_t *)data, bytes / (sizeof(int16_t) * channels), channels);
+    }
+    else if (ic1[0] != 0 || ic2[0] != 0)
+    {
+        // Bypassed: start clean when enabled again
+        memset(ic1, 0, sizeof(ic1));
+        memset(ic2, 0, sizeof(ic2));
+    }
+
+    return bytes;
+}
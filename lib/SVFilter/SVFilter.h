@@ -0,0 +1,90 @@
+#ifndef SVFILTER_H
+#define SVFILTER_H
+
+#include "Arduino.h"
+#include "AudioTools.h"
+#include <AudioConfig.h>
+#include <AsyncLog.h>
+
+// Resonant state-variable filter (trapezoidal SVF) with its own decay
+// envelope, placed after a voice's stream.
+//
+// The cutoff is a position in octaves above 20 Hz. The prewarped
+// coefficient g = tan(pi*fc/fs) comes from a table built once per sample
+// rate, so an envelope sweep costs a lookup every SUB_BLOCK samples
+// instead of a tan() per sample. Accented notes sweep further and
+// shorter, the way a 303 accent does.
+class SVFilter : public audio_tools::AudioStream
+{
+public:
+    enum Mode
+    {
+        LOWPASS,
+        BANDPASS,
+        HIGHPASS
+    };
+
+    static const uint16_t TABLE_SIZE = 256;   // over OCTAVE_RANGE octaves
+    static const uint8_t OCTAVE_RANGE = 10;   // 20 Hz .. 20 kHz
+    static const uint8_t SUB_BLOCK = 16;      // samples per coefficient update
+    static const uint8_t MAX_CHANNELS = 2;
+
+private:
+    audio_tools::AudioStream *input;
+    audio_tools::AudioInfo info;
+    float g_table[TABLE_SIZE + 1];
+
+    // Settings (control side)
+    volatile bool enabled;
+    volatile Mode mode;
+    float cutoff_octaves;
+    float resonance;
+    float env_octaves;     // sweep at full envelope
+    float decay_seconds;
+    float accent_octaves;  // extra sweep on accented notes
+    float accent_decay;    // accented notes decay at most this fast
+
+    // Envelope (audio side)
+    float env;
+    float env_depth;       // octaves for the running note
+    float env_coef;        // per sub-block multiplier
+    bool next_accent;
+
+    // Integrator state per channel
+    float ic1[MAX_CHANNELS];
+    float ic2[MAX_CHANNELS];
+
+public:
+    SVFilter();
+
+    bool begin(audio_tools::AudioInfo audioInfo);
+    void setInput(audio_tools::AudioStream &stream) { input = &stream; }
+
+    // Configuration
+    void setEnabled(bool enable);
+    void setMode(Mode filterMode) { mode = filterMode; }
+    void setCutoff(float hz);
+    void setResonance(float amount);        // 0 .. 1 (self-oscillation edge)
+    void setEnvelope(float octaves, float decay);
+    void setAccent(float octaves, float decay);
+
+    // Notes: accent applies to the next trigger only
+    void accentNext(bool accented) { next_accent = accented; }
+    void trigger(float velocity);
+
+    bool isEnabled() const { return enabled; }
+    float getCutoff() const;
+    float getEnvelope() const { return env; }
+
+    // AudioStream
+    size_t readBytes(uint8_t *data, size_t len) override;
+    size_t write(const uint8_t *data, size_t len) override { return 0; }
+    int available() override { return input ? input->available() : 0; }
+
+private:
+    void buildTable();
+    float lookupG(float octaves) const;
+    void process(int16_t *samples, uint32_t frames, uint8_t channels);
+};
+
+#endif // SVFILTER_H
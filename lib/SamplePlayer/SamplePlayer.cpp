@@ -0,0 +1,346 @@
+#include <SamplePlayer.h>
+
+SamplePlayer::SamplePlayer()
+    : out_info(defaultAudioInfo()), data_offset(0), data_samples(0), file_channels(1), file_rate(44100),
+      head_samples(0), playing(false), head_pos(0), gain_q15(0), level(0.5f),
+      generation(0), ring_generation(0), ring_eof(true), file_pos(0),
+      looping(false), loaded(false), underruns(0),
+      readerTaskHandle(NULL), fileMutex(NULL)
+{
+}
+
+SamplePlayer::~SamplePlayer()
+{
+    close();
+    if (readerTaskHandle)
+    {
+        vTaskDelete(readerTaskHandle);
+    }
+    if (fileMutex)
+    {
+        vSemaphoreDelete(fileMutex);
+    }
+}
+
+bool SamplePlayer::begin(audio_tools::AudioInfo audioInfo)
+{
+    out_info = audioInfo;
+
+    if (!fileMutex)
+    {
+        fileMutex = xSemaphoreCreateMutex();
+    }
+
+    if (!readerTaskHandle)
+    {
+        // Read-ahead on Core 0, above the pattern prefetch
+        xTaskCreatePinnedToCore(
+            readerTask,
+            "SampleTask",
+            4096,
+            this,
+            2,
+            &readerTaskHandle,
+            0 // Core 0
+        );
+    }
+
+    return fileMutex && readerTaskHandle;
+}
+
+bool SamplePlayer::open(fs::FS &fs, const char *path, bool loop)
+{
+    close();
+
+    xSemaphoreTake(fileMutex, portMAX_DELAY);
+
+    file = fs.open(path, FILE_READ);
+    if (!file || !parseHeader())
+    {
+        LOG_PRINTF("⚠️ Cannot use sample %s (16-bit PCM WAV, mono or stereo)\n", path);
+        if (file)
+        {
+            file.close();
+        }
+        xSemaphoreGive(fileMutex);
+        return false;
+    }
+
+    // No resampling: a file at another rate would play off pitch
+    if (file_rate != (uint32_t)out_info.sample_rate)
+    {
+        LOG_PRINTF("⚠️ Sample %s is %lu Hz, the output is %d Hz: convert it first\n",
+                   path, (unsigned long)file_rate, out_info.sample_rate);
+        file.close();
+        xSemaphoreGive(fileMutex);
+        return false;
+    }
+
+    // Keep the attack in RAM, whole frames only
+    head_samples = min(data_samples, HEAD_SAMPLES - HEAD_SAMPLES % file_channels);
+    file.seek(data_offset);
+    head_samples = file.read((uint8_t *)head, head_samples * sizeof(int16_t)) / sizeof(int16_t);
+
+    looping = loop;
+    ring_generation = generation - 1; // reader restarts the ring on next pass
+    loaded = true;
+
+    xSemaphoreGive(fileMutex);
+
+    LOG_PRINTF("🥣 Sample loaded: %s (%u ch, %lu Hz, %.1f s%s)\n",
+               path, file_channels, (unsigned long)file_rate,
+               (float)data_samples / file_channels / file_rate, loop ? ", loop" : "");
+    return true;
+}
+
+void SamplePlayer::close()
+{
+    playing = false;
+    if (!fileMutex)
+    {
+        return;
+    }
+
+    xSemaphoreTake(fileMutex, portMAX_DELAY);
+    loaded = false;
+    if (file)
+    {
+        file.close();
+    }
+    xSemaphoreGive(fileMutex);
+}
+
+bool SamplePlayer::parseHeader()
+{
+    uint8_t riff[12];
+    if (file.read(riff, sizeof(riff)) != sizeof(riff) ||
+        memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0)
+    {
+        return false;
+    }
+
+    bool have_format = false;
+    uint8_t chunk[8];
+    while (file.read(chunk, sizeof(chunk)) == sizeof(chunk))
+    {
+        uint32_t chunk_size = chunk[4] | (chunk[5] << 8) | (chunk[6] << 16) | ((uint32_t)chunk[7] << 24);
+        uint32_t chunk_start = file.position();
+
+        if (memcmp(chunk, "fmt ", 4) == 0)
+        {
+            uint8_t fmt[16];
+            if (chunk_size < sizeof(fmt) || file.read(fmt, sizeof(fmt)) != sizeof(fmt))
+            {
+                return false;
+            }
+            uint16_t format = fmt[0] | (fmt[1] << 8);
+            file_channels = fmt[2] | (fmt[3] << 8);
+            file_rate = fmt[4] | (fmt[5] << 8) | (fmt[6] << 16) | ((uint32_t)fmt[7] << 24);
+            uint16_t bits = fmt[14] | (fmt[15] << 8);
+
+            if (format != 1 || bits != 16 || file_channels < 1 || file_channels > 2)
+            {
+                return false;
+            }
+            have_format = true;
+        }
+        else if (memcmp(chunk, "data", 4) == 0)
+        {
+            data_offset = chunk_start;
+            data_samples = chunk_size / sizeof(int16_t);
+            data_samples -= data_samples % file_channels;
+            return have_format && data_samples > 0;
+        }
+
+        // Chunks are word aligned
+        file.seek(chunk_start + chunk_size + (chunk_size & 1));
+    }
+
+    return false;
+}
+
+void SamplePlayer::trigger(float velocity)
+{
+    if (!loaded)
+    {
+        return;
+    }
+
+    gain_q15 = (int32_t)(constrain(level * velocity, 0.0f, 1.0f) * 32767);
+    head_pos = 0;
+    generation = generation + 1;
+    playing = true;
+}
+
+void SamplePlayer::stop()
+{
+    playing = false;
+}
+
+const int16_t *SamplePlayer::peek(uint32_t &count)
+{
+    // Attack from RAM first
+    if (head_pos < head_samples)
+    {
+        count = head_samples - head_pos;
+        return head + head_pos;
+    }
+
+    // Then the ring, once the reader has restarted it for this trigger
+    if (ring_generation == generation)
+    {
+        return ring.readRegion(count);
+    }
+
+    count = 0;
+    return nullptr;
+}
+
+void SamplePlayer::consume(uint32_t count)
+{
+    if (head_pos < head_samples)
+    {
+        head_pos += count;
+    }
+    else
+    {
+        ring.commitRead(count);
+    }
+}
+
+size_t SamplePlayer::readBytes(uint8_t *data, size_t len)
+{
+    int16_t *out = (int16_t *)data;
+    uint16_t out_channels = out_info.channels;
+    size_t frames = len / (sizeof(int16_t) * out_channels);
+    size_t frame = 0;
+
+    while (playing && frame < frames)
+    {
+        uint32_t count;
+        const int16_t *src = peek(count);
+        uint32_t available_frames = count / file_channels;
+
+        if (available_frames == 0)
+        {
+            bool finished = head_pos >= head_samples &&
+                            (head_samples >= data_samples || (ring_generation == generation && ring_eof));
+            if (finished)
+            {
+                playing = false;
+            }
+            else
+            {
+                underruns++; // card too slow: play silence, never wait
+            }
+            break;
+        }
+
+        uint32_t n = min((uint32_t)(frames - frame), available_frames);
+        int16_t *dst = out + frame * out_channels;
+        if (file_channels == 1)
+        {
+            DSPKernels::interleave(src, dst, n, out_channels);
+        }
+        else if (file_channels == 2 && out_channels == 2)
+        {
+            memcpy(dst, src, n * 2 * sizeof(int16_t));
+        }
+        else
+        {
+            // Mono output takes the left channel, extra file channels are dropped
+            for (uint32_t i = 0; i < n; i++)
+            {
+                dst[i * out_channels] = src[i * file_channels];
+                if (out_channels > 1)
+                {
+                    dst[i * out_channels + 1] = src[i * file_channels + 1];
+                }
+            }
+        }
+        DSPKernels::gainRamp(dst, n, out_channels, gain_q15, gain_q15);
+
+        consume(n * file_channels);
+        frame += n;
+    }
+
+    // Silence for the rest of the block
+    if (frame < frames)
+    {
+        memset(out + frame * out_channels, 0, (frames - frame) * out_channels * sizeof(int16_t));
+    }
+    return frames * out_channels * sizeof(int16_t);
+}
+
+void SamplePlayer::readerTask(void *parameter)
+{
+    SamplePlayer *player = static_cast<SamplePlayer *>(parameter);
+
+    while (true)
+    {
+        xSemaphoreTake(player->fileMutex, portMAX_DELAY);
+        if (player->loaded)
+        {
+            if (player->ring_generation != player->generation)
+            {
+                player->restartRing();
+            }
+            player->fillRing();
+        }
+        xSemaphoreGive(player->fileMutex);
+
+        // Ring holds ~186 ms mono: refill well before it drains
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+}
+
+void SamplePlayer::restartRing()
+{
+    // The audio side does not touch the ring while generations differ
+    uint32_t target = generation;
+
+    ring.reset();
+    file_pos = head_samples;
+    ring_eof = file_pos >= data_samples && !looping;
+    file.seek(data_offset + file_pos * sizeof(int16_t));
+
+    // Prime the ring before publishing it
+    fillRing();
+    ring_generation = target;
+}
+
+void SamplePlayer::fillRing()
+{
+    while (!ring_eof && ring.writable() >= CHUNK_SAMPLES)
+    {
+        if (file_pos >= data_samples)
+        {
+            if (!looping)
+            {
+                ring_eof = true;
+                break;
+            }
+            // Loop the whole file
+            file_pos = 0;
+            file.seek(data_offset);
+        }
+
+        uint32_t count;
+        int16_t *dst = ring.writeRegion(count);
+        count = min(count, CHUNK_SAMPLES);
+        count = min(count, data_samples - file_pos);
+        count -= count % file_channels;
+
+        // Straight from the card into the ring
+        uint32_t got = file.read((uint8_t *)dst, count * sizeof(int16_t)) / sizeof(int16_t);
+        got -= got % file_channels;
+        if (got == 0)
+        {
+            ring_eof = true;
+            break;
+        }
+
+        ring.commitWrite(got);
+        file_pos += got;
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef SAMPLEPLAYER_H
+#define SAMPLEPLAYER_H
+
+#include "Arduino.h"
+#include "AudioTools.h"
+#include <AudioConfig.h>
+#include <AsyncLog.h>
+#include "FS.h"
+#include <SPSCRing.h>
+#include <DSPKernels.h>
+#include <Voice.h>
+
+// Sampler voice streaming 16-bit PCM WAV files from SD.
+//
+// The first HEAD_SAMPLES of the file stay in RAM so a trigger starts
+// instantly; the rest is read ahead into a lock-free ring by a Core 0 task.
+// The audio side only ever reads from RAM: when the ring runs dry it
+// outputs silence and counts an underrun, it never waits for the card.
+//
+// It is a voice of its own in RenderStream, at the output rate: a sample
+// plays to its end whatever the voice that triggered it is doing.
+class SamplePlayer : public audio_tools::AudioStream, public Voice
+{
+public:
+    static const uint32_t HEAD_SAMPLES = 4096;  // ~93 ms mono at 44.1 kHz
+    static const uint32_t RING_SAMPLES = 8192;  // read-ahead
+    static const uint32_t CHUNK_SAMPLES = 1024; // one SD read
+
+private:
+    audio_tools::AudioInfo out_info;
+
+    fs::File file;
+    uint32_t data_offset;  // bytes
+    uint32_t data_samples; // total samples (all channels)
+    uint16_t file_channels;
+    uint32_t file_rate;
+
+    int16_t head[HEAD_SAMPLES];
+    uint32_t head_samples;
+    SPSCRing<int16_t, RING_SAMPLES> ring;
+
+    // Audio side
+    volatile bool playing;
+    uint32_t head_pos;
+    int32_t gain_q15;
+    float level;
+
+    // Trigger handshake: the audio side bumps generation, the reader
+    // restarts the ring and publishes ring_generation when it is valid
+    volatile uint32_t generation;
+    volatile uint32_t ring_generation;
+    volatile bool ring_eof;
+    uint32_t file_pos; // samples read from the data chunk (reader side)
+
+    bool looping;
+    volatile bool loaded;
+    volatile uint32_t underruns;
+
+    TaskHandle_t readerTaskHandle;
+    SemaphoreHandle_t fileMutex;
+
+public:
+    SamplePlayer();
+    ~SamplePlayer();
+
+    bool begin(audio_tools::AudioInfo audioInfo);
+
+    // File management (Core 0)
+    bool open(fs::FS &fs, const char *path, bool loop = false);
+    void close();
+
+    // Playback (audio side)
+    void trigger(float velocity = 1.0f);
+    void stop();
+    void setLevel(float new_level) { level = new_level; }
+
+    // Voice: strike() is a trigger, a one-shot sample ignores the release
+    void strike(float frequency, float velocity) override { trigger(velocity); }
+    void release() override {}
+    bool isActive() const override { return playing; }
+    audio_tools::AudioStream *getAudioStream() override { return this; }
+
+    bool isLoaded() const { return loaded; }
+    bool isPlaying() const { return playing; }
+    uint32_t getUnderruns() const { return underruns; }
+
+    // AudioStream
+    size_t readBytes(uint8_t *data, size_t len) override;
+    size_t write(const uint8_t *data, size_t len) override { return 0; }
+    int available() override { return DEFAULT_BUFFER_SIZE; }
+
+private:
+    bool parseHeader();
+    const int16_t *peek(uint32_t &count);
+    void consume(uint32_t count);
+
+    static void readerTask(void *parameter);
+    void restartRing();
+    void fillRing();
+};
+
+#endif // SAMPLEPLAYER_H
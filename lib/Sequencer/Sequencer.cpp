@@ -1,9 +1,8 @@
 #include <Sequencer.h>
 #include <AudioTools.h>
-#include <Instrument.h>
 
 // Note frequencies table based on AudioTools defines
-const float Sequencer::note_frequencies[] = {
+const float SequencerBase::note_frequencies[] = {
     N_C0, N_CS0, N_D0, N_DS0, N_E0, N_F0, N_FS0, N_G0, N_GS0, N_A0, N_AS0, N_B0,
     N_C1, N_CS1, N_D1, N_DS1, N_E1, N_F1, N_FS1, N_G1, N_GS1, N_A1, N_AS1, N_B1,
     N_C2, N_CS2, N_D2, N_DS2, N_E2, N_F2, N_FS2, N_G2, N_GS2, N_A2, N_AS2, N_B2,
@@ -14,24 +13,79 @@ const float Sequencer::note_frequencies[] = {
     N_C7, N_CS7, N_D7, N_DS7, N_E7, N_F7, N_FS7, N_G7, N_GS7, N_A7, N_AS7, N_B7,
     N_C8, N_CS8, N_D8, N_DS8, N_E8, N_F8, N_FS8, N_G8, N_GS8, N_A8, N_AS8, N_B8};
 
-const uint8_t Sequencer::NUM_NOTES = sizeof(note_frequencies) / sizeof(note_frequencies[0]);
+const uint8_t SequencerBase::NUM_NOTES = sizeof(note_frequencies) / sizeof(note_frequencies[0]);
 
-Sequencer::Sequencer()
-    : current_step(0), num_steps(16), bpm(200), last_step_time(0), gate_off_time(0), state(STOPPED), gate_active(false), audio_generator(nullptr), instrument(nullptr), use_bowl_mode(true)
+float SequencerBase::fine_tune_ratio[256];
+
+void SequencerBase::buildTables()
 {
+    static bool ready = false;
+    if (ready)
+    {
+        return;
+    }
+
+    for (int i = 0; i < 256; i++)
+    {
+        fine_tune_ratio[i] = pow(2.0f, (int8_t)i / 1200.0f);
+    }
+    ready = true;
+}
+
+SequencerBase::Step SequencerBase::makeStep(bool active, float frequency, uint8_t velocity, uint8_t gate_length, uint8_t flags)
+{
+    uint8_t note = findNoteIndex(frequency);
+
+    // Off-table frequencies keep their offset as fine tune
+    int8_t fine_tune = 0;
+    float note_frequency = note_frequencies[note];
+    if (fabsf(frequency - note_frequency) > 0.01f && frequency > 0)
+    {
+        float cents = 1200.0f * log2f(frequency / note_frequency);
+        fine_tune = (int8_t)constrain(lroundf(cents), -128L, 127L);
+    }
+
+    return Step(Step::pack(active, note, fine_tune,
+                           constrain(velocity, 0, 127),
+                           constrain(gate_length, 1, 100),
+                           flags));
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+SequencerT<StepIndex, Capacity, NumTracks>::SequencerT()
+    : bpm(200), sample_rate(AUDIO_SAMPLE_RATE), step_length_q16(0), clock(0), state(STOPPED), swap_handler(nullptr), swap_context(nullptr), gate_scale(1.0f), tempo_scale(1.0f), audio_generator(nullptr), instrument(nullptr), use_bowl_mode(true)
+{
+    buildTables();
     calculateStepDuration();
 
-    // Initialize default pattern
-    for (uint8_t i = 0; i < MAX_STEPS; i++)
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    event_lock = unlocked;
+
+    // Initialize default pattern: track 0 plays 16 steps, the others are off
+    for (uint8_t t = 0; t < NumTracks; t++)
     {
-        steps[i].active = false;
-        steps[i].frequency = N_C0;
-        steps[i].velocity = 100;
-        steps[i].gate_length = 50;
+        Track &track = tracks[t];
+        for (StepIndex i = 0; i < MAX_STEPS; i++)
+        {
+            track.steps[i] = Step();
+            track.micro_offsets[i] = 0;
+        }
+        track.length = t == 0 ? 16 : 0;
+        track.position = 0;
+        track.current = 0;
+        track.ratio_num = 1;
+        track.ratio_den = 1;
+        track.swing = 50;
+        track.voice = nullptr;
+        track.next_grid_q16 = 0;
+        track.next_step_time = 0;
+        track.gate_off_time = 0;
+        track.gate_active = false;
     }
 }
 
-void Sequencer::setBPM(uint16_t new_bpm)
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setBPM(uint16_t new_bpm)
 {
     if (new_bpm >= 16 && new_bpm <= 200)
     {
@@ -40,140 +94,492 @@ void Sequencer::setBPM(uint16_t new_bpm)
     }
 }
 
-void Sequencer::setNumSteps(uint8_t steps)
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setSampleRate(uint32_t rate)
 {
-    if (steps >= 1 && steps <= MAX_STEPS)
+    if (rate > 0)
     {
-        num_steps = steps;
-        if (current_step >= num_steps)
-        {
-            current_step = 0;
-        }
+        sample_rate = rate;
+        calculateStepDuration();
     }
 }
 
-void Sequencer::setAudioGenerator(audio_tools::SineWaveGenerator<int16_t> *generator)
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setNumSteps(StepIndex steps)
+{
+    setTrackLength(0, steps);
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setAudioGenerator(audio_tools::SineWaveGenerator<int16_t> *generator)
 {
     audio_generator = generator;
 }
 
-void Sequencer::setBowlGenerator(Instrument *bowl)
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setBowlGenerator(Voice *bowl)
 {
     instrument = bowl;
-    Serial.println("Bowl generator connected to sequencer");
+    LOG_PRINTLN("Bowl generator connected to sequencer");
 }
 
-void Sequencer::setBowlMode(bool enable)
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setBowlMode(bool enable)
 {
     use_bowl_mode = enable;
-    Serial.printf("Sequencer bowl mode: %s\n", enable ? "ENABLED" : "DISABLED");
+    LOG_PRINTF("Sequencer bowl mode: %s\n", enable ? "ENABLED" : "DISABLED");
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setGateScale(float scale)
+{
+    gate_scale = constrain(scale, 0.05f, 4.0f);
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setTempoScale(float scale)
+{
+    scale = constrain(scale, 0.25f, 4.0f);
+    if (fabsf(scale - tempo_scale) > 0.001f)
+    {
+        tempo_scale = scale;
+        calculateStepDuration();
+    }
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setTrackLength(uint8_t track, StepIndex length)
+{
+    if (track < NumTracks && length <= MAX_STEPS && (length >= 1 || track > 0))
+    {
+        Track &t = tracks[track];
+        bool was_enabled = t.length > 0;
+        t.length = length;
+        if (t.position >= length)
+        {
+            t.position = 0;
+        }
+        if (t.current >= length)
+        {
+            t.current = 0;
+        }
+
+        // A track switched on joins on the clock, one switched off drops its events
+        if (state == PLAYING && was_enabled != (length > 0))
+        {
+            restartTrack(track);
+        }
+    }
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setTrackRatio(uint8_t track, uint8_t num, uint8_t den)
+{
+    if (track < NumTracks && num > 0 && den > 0)
+    {
+        tracks[track].ratio_num = num;
+        tracks[track].ratio_den = den;
+    }
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setTrackSwing(uint8_t track, uint8_t swing_percent)
+{
+    if (track < NumTracks)
+    {
+        tracks[track].swing = constrain(swing_percent, (uint8_t)50, (uint8_t)75);
+    }
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setTrackVoice(uint8_t track, Voice *voice)
+{
+    if (track < NumTracks)
+    {
+        tracks[track].voice = voice;
+    }
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setTrackStep(uint8_t track, StepIndex step_index, Step step)
+{
+    if (track < NumTracks && step_index < MAX_STEPS)
+    {
+        tracks[track].steps[step_index] = step;
+    }
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+SequencerBase::Step SequencerT<StepIndex, Capacity, NumTracks>::getTrackStep(uint8_t track, StepIndex step_index) const
+{
+    if (track < NumTracks && step_index < MAX_STEPS)
+    {
+        return tracks[track].steps[step_index];
+    }
+    return Step();
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setTrackMicroOffset(uint8_t track, StepIndex step_index, int16_t samples)
+{
+    if (track < NumTracks && step_index < MAX_STEPS)
+    {
+        tracks[track].micro_offsets[step_index] = samples;
+    }
 }
 
-void Sequencer::play()
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+int16_t SequencerT<StepIndex, Capacity, NumTracks>::getTrackMicroOffset(uint8_t track, StepIndex step_index) const
 {
+    if (track < NumTracks && step_index < MAX_STEPS)
+    {
+        return tracks[track].micro_offsets[step_index];
+    }
+    return 0;
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::resetTracks()
+{
+    // Track 0 back to a straight grid, without the previous pattern's offsets
+    tracks[0].ratio_num = 1;
+    tracks[0].ratio_den = 1;
+    tracks[0].swing = 50;
+    memset(tracks[0].micro_offsets, 0, sizeof(tracks[0].micro_offsets));
+
+    for (uint8_t t = 1; t < NumTracks; t++)
+    {
+        Track &track = tracks[t];
+        if (track.gate_active)
+        {
+            track.gate_active = false;
+            if (voiceOf(track))
+            {
+                voiceOf(track)->release();
+            }
+        }
+        track.length = 0;
+        track.ratio_num = 1;
+        track.ratio_den = 1;
+        track.swing = 50;
+    }
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::play()
+{
+    // Every track restarts on the same sample, from its current position
+    for (uint8_t t = 0; t < NumTracks; t++)
+    {
+        restartTrack(t);
+    }
     state = PLAYING;
-    last_step_time = millis();
 }
 
-void Sequencer::stop()
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::restartTrack(uint8_t t)
+{
+    Track &track = tracks[t];
+    if (track.gate_active)
+    {
+        track.gate_active = false;
+        if (voiceOf(track))
+        {
+            voiceOf(track)->release();
+        }
+    }
+
+    portENTER_CRITICAL(&event_lock);
+    events.removeIf([t](const ClockEvent &event)
+                    { return event.track == t && (event.type == ClockEvent::NOTE_ON || event.type == ClockEvent::GATE_OFF); });
+    portEXIT_CRITICAL(&event_lock);
+
+    if (track.length > 0)
+    {
+        track.next_grid_q16 = clock << 16;
+        track.next_step_time = max(stepFireTime(track), clock);
+        pushEvent(track.next_step_time, ClockEvent::NOTE_ON, t);
+    }
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+bool SequencerT<StepIndex, Capacity, NumTracks>::scheduleParameter(uint64_t time, Parameter param, float value, uint8_t track)
+{
+    return track < NumTracks && pushEvent(time, ClockEvent::PARAMETER, track, param, value);
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+bool SequencerT<StepIndex, Capacity, NumTracks>::schedulePatternSwap(uint64_t time, uint16_t pattern)
+{
+    return pushEvent(time, ClockEvent::PATTERN_SWAP, 0, pattern);
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setPatternSwapHandler(PatternSwapHandler handler, void *context)
+{
+    swap_context = context;
+    swap_handler = handler;
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+uint64_t SequencerT<StepIndex, Capacity, NumTracks>::nextBarTime() const
+{
+    if (state != PLAYING)
+    {
+        return clock;
+    }
+
+    // Grid time of the next step of track 0 that starts a 16-step bar,
+    // the one after if that bar line is now
+    const Track &track = tracks[0];
+    uint64_t length = trackStepLength(track);
+    StepIndex to_bar = (16 - track.position % 16) % 16;
+    uint64_t time = (track.next_grid_q16 + to_bar * length) >> 16;
+    if (time <= clock)
+    {
+        time = (track.next_grid_q16 + (to_bar + 16) * length) >> 16;
+    }
+    return time;
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::stop()
 {
     state = STOPPED;
-    current_step = 0;
-    gate_active = false;
-    stopGate();
+    reset();
+
+    // Nothing scheduled for this playback may fire on the next play():
+    // parameter changes are dropped, pattern swaps land now (their owner
+    // is waiting for them)
+    static const uint8_t MAX_PENDING_SWAPS = 8;
+    uint16_t swaps[MAX_PENDING_SWAPS];
+    uint8_t num_swaps = 0;
+
+    portENTER_CRITICAL(&event_lock);
+    events.removeIf([&](const ClockEvent &event)
+                    {
+                        if (event.type == ClockEvent::PATTERN_SWAP && num_swaps < MAX_PENDING_SWAPS)
+                        {
+                            swaps[num_swaps++] = event.id;
+                        }
+                        return event.type == ClockEvent::PARAMETER || event.type == ClockEvent::PATTERN_SWAP; });
+    portEXIT_CRITICAL(&event_lock);
+
+    for (uint8_t i = 0; i < num_swaps && swap_handler; i++)
+    {
+        swap_handler(swap_context, swaps[i]);
+    }
 }
 
-void Sequencer::pause()
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::pause()
 {
     state = PAUSED;
-    gate_active = false;
-    stopGate();
+    releaseAll();
 }
 
-void Sequencer::reset()
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::reset()
 {
-    current_step = 0;
-    gate_active = false;
-    stopGate();
+    for (uint8_t t = 0; t < NumTracks; t++)
+    {
+        tracks[t].position = 0;
+        tracks[t].current = 0;
+    }
+    releaseAll();
 }
 
-void Sequencer::setStep(uint8_t step_index, bool active, float frequency, uint8_t velocity, uint8_t gate_length)
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setStep(StepIndex step_index, bool active, float frequency, uint8_t velocity, uint8_t gate_length)
 {
     if (step_index < MAX_STEPS)
     {
-        steps[step_index].active = active;
-        steps[step_index].frequency = frequency;
-        steps[step_index].velocity = constrain(velocity, 0, 127);
-        steps[step_index].gate_length = constrain(gate_length, 1, 100);
+        // A rewritten step starts back on the grid
+        tracks[0].steps[step_index] = makeStep(active, frequency, velocity, gate_length);
+        tracks[0].micro_offsets[step_index] = 0;
     }
 }
 
-void Sequencer::setStepActive(uint8_t step_index, bool active)
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setStep(StepIndex step_index, Step step)
+{
+    // A rewritten step starts back on the grid, like the float overload
+    setTrackStep(0, step_index, step);
+    setTrackMicroOffset(0, step_index, 0);
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setStepActive(StepIndex step_index, bool active)
 {
     if (step_index < MAX_STEPS)
     {
-        steps[step_index].active = active;
+        const Step &step = tracks[0].steps[step_index];
+        tracks[0].steps[step_index] = Step(Step::pack(active, step.note(), step.fineTune(), step.velocity(), step.gateLength(),
+                                                      step.flags() & ~Step::FLAG_ACTIVE));
     }
 }
 
-void Sequencer::setStepFrequency(uint8_t step_index, float frequency)
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setStepFrequency(StepIndex step_index, float frequency)
 {
     if (step_index < MAX_STEPS)
     {
-        steps[step_index].frequency = frequency;
+        const Step &step = tracks[0].steps[step_index];
+        tracks[0].steps[step_index] = makeStep(step.active(), frequency, step.velocity(), step.gateLength(),
+                                               step.flags() & ~Step::FLAG_ACTIVE);
     }
 }
 
-void Sequencer::setStepVelocity(uint8_t step_index, uint8_t velocity)
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setStepVelocity(StepIndex step_index, uint8_t velocity)
 {
     if (step_index < MAX_STEPS)
     {
-        steps[step_index].velocity = constrain(velocity, 0, 127);
+        const Step &step = tracks[0].steps[step_index];
+        tracks[0].steps[step_index] = Step(Step::pack(step.active(), step.note(), step.fineTune(), constrain(velocity, 0, 127),
+                                                      step.gateLength(), step.flags() & ~Step::FLAG_ACTIVE));
     }
 }
 
-void Sequencer::setStepGateLength(uint8_t step_index, uint8_t gate_length)
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::setStepGateLength(StepIndex step_index, uint8_t gate_length)
 {
     if (step_index < MAX_STEPS)
     {
-        steps[step_index].gate_length = constrain(gate_length, 1, 100);
+        const Step &step = tracks[0].steps[step_index];
+        tracks[0].steps[step_index] = Step(Step::pack(step.active(), step.note(), step.fineTune(), step.velocity(),
+                                                      constrain(gate_length, 1, 100), step.flags() & ~Step::FLAG_ACTIVE));
     }
 }
 
-Sequencer::Step Sequencer::getStep(uint8_t step_index) const
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+SequencerBase::Step SequencerT<StepIndex, Capacity, NumTracks>::getStep(StepIndex step_index) const
 {
-    if (step_index < MAX_STEPS)
+    return getTrackStep(0, step_index);
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::processEvents()
+{
+    if (state != PLAYING)
     {
-        return steps[step_index];
+        return;
+    }
+
+    // Only the head of the queue is ever looked at
+    ClockEvent event;
+    while (popDueEvent(event))
+    {
+        dispatch(event);
     }
-    return Step();
 }
 
-void Sequencer::update()
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+uint32_t SequencerT<StepIndex, Capacity, NumTracks>::framesUntilNextEvent() const
 {
     if (state != PLAYING)
     {
-        return;
+        return 0xFFFFFFFF;
+    }
+
+    portENTER_CRITICAL(&event_lock);
+    bool empty = events.empty();
+    uint64_t next = empty ? 0 : events.top().time;
+    portEXIT_CRITICAL(&event_lock);
+
+    if (empty)
+    {
+        return 0xFFFFFFFF;
     }
+    if (next <= clock)
+    {
+        return 1;
+    }
+    return (uint32_t)min(next - clock, (uint64_t)0xFFFFFFFF);
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+bool SequencerT<StepIndex, Capacity, NumTracks>::pushEvent(uint64_t time, uint8_t type, uint8_t track, uint16_t id, float value)
+{
+    ClockEvent event;
+    event.time = time;
+    event.type = type;
+    event.track = track;
+    event.id = id;
+    event.value = value;
+
+    portENTER_CRITICAL(&event_lock);
+    bool ok = events.push(event);
+    portEXIT_CRITICAL(&event_lock);
+    return ok;
+}
 
-    uint32_t current_time = millis();
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+bool SequencerT<StepIndex, Capacity, NumTracks>::popDueEvent(ClockEvent &event)
+{
+    portENTER_CRITICAL(&event_lock);
+    bool due = !events.empty() && events.top().time <= clock && events.pop(event);
+    portEXIT_CRITICAL(&event_lock);
+    return due;
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::dispatch(const ClockEvent &event)
+{
+    Track &track = tracks[event.track];
 
-    // Check if we need to advance to next step
-    if (current_time - last_step_time >= step_duration_ms)
+    switch (event.type)
     {
-        nextStep();
-        triggerStep();
-        last_step_time = current_time;
+    case ClockEvent::GATE_OFF:
+        // Ignored if a later note re-armed the gate or a rest closed it
+        if (track.gate_active && track.gate_off_time == event.time)
+        {
+            track.gate_active = false;
+            if (voiceOf(track))
+            {
+                voiceOf(track)->release();
+            }
+        }
+        break;
+
+    case ClockEvent::PARAMETER:
+        applyParameter(event);
+        break;
+
+    case ClockEvent::PATTERN_SWAP:
+        if (swap_handler)
+        {
+            swap_handler(swap_context, event.id);
+        }
+        break;
+
+    case ClockEvent::NOTE_ON:
+        if (track.length > 0)
+        {
+            fireStep(event.track);
+        }
+        break;
     }
+}
 
-    // Check if we need to turn off gate
-    if (gate_active && current_time >= gate_off_time)
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::applyParameter(const ClockEvent &event)
+{
+    switch (event.id)
     {
-        stopGate();
+    case PARAM_BPM:
+        setBPM((uint16_t)event.value);
+        break;
+    case PARAM_SWING:
+        setTrackSwing(event.track, (uint8_t)event.value);
+        break;
+    case PARAM_TRACK_LENGTH:
+        setTrackLength(event.track, (StepIndex)event.value);
+        break;
     }
 }
 
-float Sequencer::getNoteFrequency(uint8_t note_index)
+float SequencerBase::getNoteFrequency(uint8_t note_index)
 {
     if (note_index < NUM_NOTES)
     {
@@ -182,79 +588,160 @@ float Sequencer::getNoteFrequency(uint8_t note_index)
     return N_A0;
 }
 
-void Sequencer::printStatus() const
+uint8_t SequencerBase::findNoteIndex(float frequency)
+{
+    // Nearest note in the table (frequencies are sorted)
+    uint8_t best = 0;
+    float best_distance = fabsf(note_frequencies[0] - frequency);
+    for (uint8_t i = 1; i < NUM_NOTES; i++)
+    {
+        float distance = fabsf(note_frequencies[i] - frequency);
+        if (distance > best_distance)
+        {
+            break;
+        }
+        best_distance = distance;
+        best = i;
+    }
+    return best;
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::printStatus() const
 {
     Serial.println("=== SEQUENCER STATUS ===");
     Serial.printf("State: %s\n",
                   state == PLAYING ? "PLAYING" : state == PAUSED ? "PAUSED"
                                                                  : "STOPPED");
     Serial.printf("BPM: %d\n", bpm);
-    Serial.printf("Steps: %d/%d\n", num_steps, MAX_STEPS);
-    Serial.printf("Current Step: %d\n", current_step);
-    Serial.printf("Gate: %s\n", gate_active ? "ACTIVE" : "INACTIVE");
+    for (uint8_t t = 0; t < NumTracks; t++)
+    {
+        const Track &track = tracks[t];
+        if (track.length == 0)
+        {
+            continue;
+        }
+        Serial.printf("Track %d: step %d/%d | ratio %d/%d | swing %d%% | gate %s\n",
+                      t, track.current, track.length, track.ratio_num, track.ratio_den,
+                      track.swing, track.gate_active ? "ACTIVE" : "INACTIVE");
+    }
     Serial.printf("Bowl Mode: %s\n", use_bowl_mode ? "ON" : "OFF");
-    Serial.printf("Step Duration: %d ms\n", step_duration_ms);
+    Serial.printf("Step Duration: %lu samples\n", (unsigned long)(step_length_q16 >> 16));
     Serial.println();
 }
 
-void Sequencer::printPattern() const
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::printPattern() const
 {
     Serial.println("=== PATTERN ===");
-    for (uint8_t i = 0; i < num_steps; i++)
+    for (StepIndex i = 0; i < tracks[0].length; i++)
     {
+        const Step &step = tracks[0].steps[i];
         Serial.printf("Step %2d: %s | %.2f Hz | V:%d | G:%d%%\n",
                       i,
-                      steps[i].active ? "ON " : "OFF",
-                      steps[i].frequency,
-                      steps[i].velocity,
-                      steps[i].gate_length);
+                      step.active() ? "ON " : "OFF",
+                      step.frequency(),
+                      step.velocity(),
+                      step.gateLength());
     }
     Serial.println();
 }
 
-void Sequencer::calculateStepDuration()
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::calculateStepDuration()
+{
+    // For 16th notes: sample_rate * 60 / BPM / 4, kept in Q16 so long
+    // songs do not drift
+    float samples = (sample_rate * 60.0f) / (bpm * tempo_scale * 4.0f);
+    step_length_q16 = (uint64_t)(samples * 65536.0f);
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+uint64_t SequencerT<StepIndex, Capacity, NumTracks>::trackStepLength(const Track &track) const
+{
+    return step_length_q16 * track.ratio_num / track.ratio_den;
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::scheduleNextStep(Track &track)
 {
-    // For 16th notes: 60000ms / BPM / 4
-    step_duration_ms = (60000 / bpm) / 4;
+    track.next_grid_q16 += trackStepLength(track);
+    track.next_step_time = stepFireTime(track);
 }
 
-void Sequencer::triggerStep()
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+uint64_t SequencerT<StepIndex, Capacity, NumTracks>::stepFireTime(const Track &track) const
 {
-    if (current_step >= num_steps)
+    uint64_t length = trackStepLength(track);
+    int64_t fire_q16 = track.next_grid_q16;
+
+    // Swing: the odd step of each pair sits at swing% of the pair
+    // (50% straight, 66% triplet), i.e. (swing - 50) / 50 of a step late
+    if (track.position & 1)
     {
-        return;
+        fire_q16 += length * (track.swing - 50) / 50;
     }
 
-    const Step &step = steps[current_step];
+    // Micro-offset in samples, kept within a quarter step: with the
+    // maximum swing (half a step) two steps can meet but never swap
+    int64_t max_offset = length / 4;
+    int64_t offset_q16 = (int64_t)track.micro_offsets[track.position] << 16;
+    fire_q16 += constrain(offset_q16, -max_offset, max_offset);
 
-    if (step.active)
-    {
-        float velocity_normalized = step.velocity / 127.0f;
-        instrument->strike(step.frequency, velocity_normalized);
+    return fire_q16 > 0 ? (uint64_t)fire_q16 >> 16 : 0;
+}
+
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::fireStep(uint8_t t)
+{
+    Track &track = tracks[t];
+    Voice *voice = voiceOf(track);
 
-        gate_active = true;
-        uint32_t gate_duration = (step_duration_ms * step.gate_length) / 100;
-        gate_off_time = millis() + gate_duration;
-    } else {
+    // Single word read, fields unpacked in registers
+    const Step step = track.steps[track.position];
+    track.current = track.position;
+
+    if (step.active() && voice)
+    {
+        float velocity_normalized = step.velocity() / 127.0f;
+        voice->setAccent(step.accent());
+        voice->strike(step.frequency(), velocity_normalized);
+
+        uint64_t step_samples = trackStepLength(track) >> 16;
+        uint64_t gate_samples = (uint64_t)(step_samples * step.gateLength() * gate_scale / 100);
+        track.gate_active = true;
+        track.gate_off_time = clock + max(gate_samples, (uint64_t)1);
+        pushEvent(track.gate_off_time, ClockEvent::GATE_OFF, t);
+    }
+    else if (track.gate_active && voice)
+    {
         // ✅ Step silencieux - forcer le release
-        instrument->release();
-        gate_active = false;
+        voice->release();
+        track.gate_active = false;
     }
-}
 
-void Sequencer::stopGate()
-{
-    gate_active = false;
-  
-    instrument->release();
-    
+    track.position++;
+    if (track.position >= track.length)
+    {
+        track.position = 0;
+    }
+    scheduleNextStep(track);
+    pushEvent(track.next_step_time, ClockEvent::NOTE_ON, t);
 }
 
-void Sequencer::nextStep()
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+void SequencerT<StepIndex, Capacity, NumTracks>::releaseAll()
 {
-    current_step++;
-    if (current_step >= num_steps)
+    for (uint8_t t = 0; t < NumTracks; t++)
     {
-        current_step = 0;
+        Track &track = tracks[t];
+        track.gate_active = false;
+        if (voiceOf(track))
+        {
+            voiceOf(track)->release();
+        }
     }
-}
\ No newline at end of file
+}
+
+// Sizes used by the firmware
+template class SequencerT<uint16_t, 512, 4>;
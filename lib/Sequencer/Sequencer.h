@@ -3,97 +3,231 @@
 
 #include "Arduino.h"
 #include "AudioTools.h"
+#include <AudioConfig.h>
+#include <AsyncLog.h>
+#include <RenderClock.h>
+#include <EventQueue.h>
+#include <Voice.h>
 
-// Forward declaration for TibetanBowl
-class Instrument;
-
-class Sequencer {
+// Types and note tables shared by every sequencer size
+class SequencerBase {
 public:
-    static const uint8_t MAX_STEPS = 128;
-    
+    // One step packed in a single 32-bit word:
+    //   bits  0-6  note index in the note table
+    //   bits  7-14 fine tune, signed cents
+    //   bits 15-21 velocity (0-127)
+    //   bits 22-28 gate length (1-100 %)
+    //   bits 29-31 flags
     struct Step {
-        bool active;
-        float frequency;
-        uint8_t velocity;
-        uint8_t gate_length;
-        
-        Step() : active(false), frequency(440.0f), velocity(100), gate_length(50) {}
+        uint32_t bits;
+
+        static const uint32_t FLAG_ACTIVE = 0x1;
+        static const uint32_t FLAG_ACCENT = 0x2;
+
+        Step() : bits(pack(false, 0, 0, 100, 50)) {}
+        explicit Step(uint32_t raw) : bits(raw) {}
+
+        static uint32_t pack(bool active, uint8_t note, int8_t fine_tune, uint8_t velocity, uint8_t gate_length, uint8_t flags = 0)
+        {
+            if (active) flags |= FLAG_ACTIVE;
+            return (uint32_t)(note & 0x7F) |
+                   ((uint32_t)(uint8_t)fine_tune << 7) |
+                   ((uint32_t)(velocity & 0x7F) << 15) |
+                   ((uint32_t)(gate_length & 0x7F) << 22) |
+                   ((uint32_t)(flags & 0x7) << 29);
+        }
+
+        uint8_t note() const { return bits & 0x7F; }
+        int8_t fineTune() const { return (int8_t)((bits >> 7) & 0xFF); }
+        uint8_t velocity() const { return (bits >> 15) & 0x7F; }
+        uint8_t gateLength() const { return (bits >> 22) & 0x7F; }
+        uint8_t flags() const { return (bits >> 29) & 0x7; }
+        bool active() const { return flags() & FLAG_ACTIVE; }
+        bool accent() const { return flags() & FLAG_ACCENT; }
+        float frequency() const { return SequencerBase::stepFrequency(note(), fineTune()); }
     };
-    
+
     enum State {
         STOPPED,
         PLAYING,
         PAUSED
     };
 
+    // Parameters that can be changed on a scheduled sample
+    enum Parameter {
+        PARAM_BPM,
+        PARAM_SWING,       // per track
+        PARAM_TRACK_LENGTH // per track
+    };
+
+    // Runs on the audio task when a scheduled pattern swap is due: keep it short
+    typedef void (*PatternSwapHandler)(void *context, uint16_t pattern);
+
+    // Utilities
+    static float getNoteFrequency(uint8_t note_index);
+    static uint8_t findNoteIndex(float frequency);
+    static uint8_t getNumAvailableNotes() { return NUM_NOTES; }
+    static Step makeStep(bool active, float frequency, uint8_t velocity = 100, uint8_t gate_length = 50, uint8_t flags = 0);
+    static float stepFrequency(uint8_t note_index, int8_t fine_tune)
+    {
+        float frequency = getNoteFrequency(note_index);
+        return fine_tune ? frequency * fine_tune_ratio[(uint8_t)fine_tune] : frequency;
+    }
+
+protected:
+    // Note frequencies table
+    static const float note_frequencies[];
+    static const uint8_t NUM_NOTES;
+
+    // 2^(cents/1200) for every int8 fine tune value
+    static float fine_tune_ratio[256];
+    static void buildTables();
+};
+
+// Multi-track step sequencer running on the render sample clock.
+//
+// StepIndex sets the width of the step counters, Capacity the size of each
+// track's (packed) step table and NumTracks the number of tracks. Every track
+// has its own length, clock ratio, swing and target voice; all of them are
+// scheduled from the same sample counter, so a 12-step track against a
+// 16-step track stays locked without extra tasks. Swing and per-step
+// micro-offsets are resolved in samples when a step is scheduled, and
+// RenderStream splits the block so the note lands on that exact sample.
+//
+// Upcoming note-ons, gate-offs, parameter changes and pattern swaps sit in
+// one time-sorted event queue: the render loop only looks at its head, both
+// to fire what is due and to know how far it can render in one go.
+//
+// The single-track API (setStep, setNumSteps, getCurrentStep...) works on track 0.
+template <typename StepIndex, StepIndex Capacity, uint8_t NumTracks>
+class SequencerT : public SequencerBase, public RenderClock {
+public:
+    static const StepIndex MAX_STEPS = Capacity;
+    static const uint8_t MAX_TRACKS = NumTracks;
+
 private:
-    Step steps[MAX_STEPS];
-    uint8_t current_step;
-    uint8_t num_steps;
+    struct Track {
+        Step steps[Capacity];
+        int16_t micro_offsets[Capacity]; // signed, samples
+        StepIndex length;         // 0 = track disabled
+        StepIndex position;       // next step to fire
+        StepIndex current;        // last step fired
+        uint8_t ratio_num;        // step length = base step x num / den
+        uint8_t ratio_den;
+        uint8_t swing;            // 50 = straight, 66 = triplet feel, 75 max
+        Voice *voice;             // nullptr = default voice
+        uint64_t next_grid_q16;   // straight-grid time of the next step, Q16 samples
+        uint64_t next_step_time;  // fire time including swing and offset, samples
+        uint64_t gate_off_time;
+        bool gate_active;
+    };
+
+    Track tracks[NumTracks];
     uint16_t bpm;
-    uint32_t step_duration_ms;
-    uint32_t last_step_time;
-    uint32_t gate_off_time;
+    uint32_t sample_rate;
+    uint64_t step_length_q16; // one 16th note, Q16 samples
+    uint64_t clock;           // samples rendered since boot
     State state;
-    bool gate_active;
-    
+
+    // Per track: the next note-on plus pending gate-offs (up to 4 steps
+    // long with the gate scale), then room for scheduled changes
+    EventQueue<NumTracks * 5 + 16> events;
+    mutable portMUX_TYPE event_lock;
+    PatternSwapHandler swap_handler;
+    void *swap_context;
+
+    // Control-rate modulation (1.0 = unchanged)
+    float gate_scale;
+    float tempo_scale;
+
     // Audio generators
     audio_tools::SineWaveGenerator<int16_t>* audio_generator;
-    Instrument* instrument;
+    Voice* instrument;
     bool use_bowl_mode;
-    
-    // Note frequencies table
-    static const float note_frequencies[];
-    static const uint8_t NUM_NOTES;
 
 public:
-    Sequencer();
-    
+    SequencerT();
+
     // Configuration
     void setBPM(uint16_t bpm);
-    void setNumSteps(uint8_t steps);
+    void setSampleRate(uint32_t rate);
+    void setNumSteps(StepIndex steps);
     void setAudioGenerator(audio_tools::SineWaveGenerator<int16_t>* generator);
-    void setBowlGenerator(Instrument* bowl);
+    void setBowlGenerator(Voice* bowl);
     void setBowlMode(bool enable);
-    
+    void setGateScale(float scale);
+    void setTempoScale(float scale);
+
+    // Tracks
+    void setTrackLength(uint8_t track, StepIndex length);
+    void setTrackRatio(uint8_t track, uint8_t num, uint8_t den);
+    void setTrackSwing(uint8_t track, uint8_t swing_percent);
+    void setTrackVoice(uint8_t track, Voice *voice);
+    void setTrackStep(uint8_t track, StepIndex step_index, Step step);
+    Step getTrackStep(uint8_t track, StepIndex step_index) const;
+    void setTrackMicroOffset(uint8_t track, StepIndex step_index, int16_t samples);
+    int16_t getTrackMicroOffset(uint8_t track, StepIndex step_index) const;
+    StepIndex getTrackLength(uint8_t track) const { return track < NumTracks ? tracks[track].length : 0; }
+    StepIndex getTrackPosition(uint8_t track) const { return track < NumTracks ? tracks[track].current : 0; }
+    void resetTracks();
+
+    // Scheduled changes (any task), applied on their exact sample
+    bool scheduleParameter(uint64_t time, Parameter param, float value, uint8_t track = 0);
+    bool schedulePatternSwap(uint64_t time, uint16_t pattern);
+    void setPatternSwapHandler(PatternSwapHandler handler, void *context);
+    uint64_t nextBarTime() const;
+    uint32_t getEventOverflows() const { return events.getOverflows(); }
+
     // Playback control
     void play();
     void stop();
     void pause();
     void reset();
-    
-    // Step editing
-    void setStep(uint8_t step_index, bool active, float frequency, uint8_t velocity = 100, uint8_t gate_length = 50);
-    void setStepActive(uint8_t step_index, bool active);
-    void setStepFrequency(uint8_t step_index, float frequency);
-    void setStepVelocity(uint8_t step_index, uint8_t velocity);
-    void setStepGateLength(uint8_t step_index, uint8_t gate_length);
-    
+
+    // Step editing (track 0)
+    void setStep(StepIndex step_index, bool active, float frequency, uint8_t velocity = 100, uint8_t gate_length = 50);
+    void setStep(StepIndex step_index, Step step);
+    void setStepActive(StepIndex step_index, bool active);
+    void setStepFrequency(StepIndex step_index, float frequency);
+    void setStepVelocity(StepIndex step_index, uint8_t velocity);
+    void setStepGateLength(StepIndex step_index, uint8_t gate_length);
+    void setStepMicroOffset(StepIndex step_index, int16_t samples) { setTrackMicroOffset(0, step_index, samples); }
+
     // Data access
-    Step getStep(uint8_t step_index) const;
-    uint8_t getCurrentStep() const { return current_step; }
-    uint8_t getNumSteps() const { return num_steps; }
+    Step getStep(StepIndex step_index) const;
+    StepIndex getCurrentStep() const { return tracks[0].current; }
+    StepIndex getNumSteps() const { return tracks[0].length; }
     uint16_t getBPM() const { return bpm; }
     State getState() const { return state; }
-    bool isGateActive() const { return gate_active; }
+    bool isGateActive() const { return tracks[0].gate_active; }
     bool isBowlMode() const { return use_bowl_mode; }
-    
-    // Main update function
-    void update();
-    
-    // Utilities
-    static float getNoteFrequency(uint8_t note_index);
-    static uint8_t getNumAvailableNotes() { return NUM_NOTES; }
-    
+    uint64_t getClock() const { return clock; }
+
+    // RenderClock
+    void processEvents() override;
+    uint32_t framesUntilNextEvent() const override;
+    void advance(uint32_t frames) override { clock += frames; }
+
     // Debug
     void printStatus() const;
     void printPattern() const;
 
 private:
     void calculateStepDuration();
-    void triggerStep();
-    void stopGate();
-    void nextStep();
+    uint64_t trackStepLength(const Track &track) const;
+    void scheduleNextStep(Track &track);
+    uint64_t stepFireTime(const Track &track) const;
+    void restartTrack(uint8_t t);
+    bool pushEvent(uint64_t time, uint8_t type, uint8_t track, uint16_t id = 0, float value = 0);
+    bool popDueEvent(ClockEvent &event);
+    void dispatch(const ClockEvent &event);
+    void applyParameter(const ClockEvent &event);
+    void fireStep(uint8_t t);
+    void releaseAll();
+    Voice *voiceOf(const Track &track) const { return track.voice ? track.voice : instrument; }
 };
 
-#endif // SEQUENCER_H
\ No newline at end of file
+// 4 tracks x 512 steps x (4 + 2) bytes = 12 KB
+typedef SequencerT<uint16_t, 512, 4> Sequencer;
+
+#endif // SEQUENCER_H
@@ -25,15 +25,19 @@ const float SynthController::range[] = {
 const uint8_t SynthController::NUM_NOTES = sizeof(range) / sizeof(range[0]);
 
 SynthController::SynthController()
-    : sineWave(nullptr), sound(nullptr), instrument(nullptr),  info(44100, 2, 16)
+    : sineWave(nullptr), sound(nullptr), instrument(nullptr), muxController(nullptr), last_modulation_us(0), current_style("tibetan"), info(defaultAudioInfo())
 {
+    memset(voices, 0, sizeof(voices));
 }
 
 SynthController::~SynthController()
 {
-    if (instrument)
+    for (uint8_t v = 0; v < NUM_VOICES; v++)
     {
-        delete instrument;
+        if (voices[v])
+        {
+            delete voices[v];
+        }
     }
     if (sound)
     {
@@ -49,38 +53,172 @@ bool SynthController::begin(audio_tools::AudioInfo audioInfo)
 {
     info = audioInfo;
 
-    Serial.println("SynthController initialization...");
+    LOG_PRINTLN("SynthController initialization...");
 
     // Initialize audio components
     initializeAudioComponents();
 
-    // Initialize Tibetan Bowl
-    instrument = new Instrument();
-    if (!instrument->begin(info))
+    // Initialize Tibetan Bowl voices
+    renderStream.begin(info);
+    for (uint8_t v = 0; v < NUM_VOICES; v++)
     {
-        Serial.println("Warning: Failed to initialize TibetanBowl");
+        voices[v] = new Instrument();
+        if (!voices[v]->begin(info))
+        {
+            LOG_PRINTF("Warning: Failed to initialize TibetanBowl voice %d\n", v);
+        }
+        renderStream.addVoice(voices[v]);
+    }
+    instrument = voices[0];
+
+    // 16 modes: every partial beats against its doublet
+    modalBowl.setModes(16);
+    if (modalBowl.begin(info))
+    {
+        renderStream.addVoice(&modalBowl);
     }
 
     // Connect both generators to sequencer
     sequencer.setAudioGenerator(sineWave); // CETTE LIGNE MANQUAIT !
     sequencer.setBowlGenerator(instrument);
+    sequencer.setSampleRate(info.sample_rate);
+
+    // The sequencer runs on the render sample clock
+    renderStream.setClock(&sequencer);
+
+    // Shared room for all the voices: 4 lines leave room for the VCOs on Core 1
+    if (reverb.begin(info.sample_rate))
+    {
+        reverb.setLines(4);
+        renderStream.setReverb(&reverb);
+    }
+
+    // Soft clipper and meters on the final sum
+    masterBus.begin();
+    renderStream.setMasterBus(&masterBus);
+
+    // Click hunting on the final output
+    if (glitchDetector.begin(info.sample_rate, info.channels))
+    {
+        renderStream.setGlitchDetector(&glitchDetector);
+    }
+
+    // Tee to SD, idle until a recording is started
+    recorder.begin(info.sample_rate, info.channels);
+    renderStream.setRecorder(&recorder);
+
+    // Half of the voices and the reverb on Core 0 (build option, see AudioConfig.h)
+    if (AUDIO_DUAL_CORE)
+    {
+        renderStream.setDualCore(true);
+    }
 
     // Start in sine mode by default
     sequencer.setBowlMode(true);
 
-    Serial.println("SynthController initialized successfully");
+    // Route the front panel pots
+    loadDefaultModRoutes();
+
+    // Pattern generators on Core 0
+    patternEngine.begin(&sequencer);
+
+    LOG_PRINTLN("SynthController initialized successfully");
     return true;
 }
 
 void SynthController::update()
 {
-    // Update sequencer timing and note triggers
-    sequencer.update();
+    // Control-rate modulation, once per audio block
+    // (sequencer timing and note triggers run inside renderStream)
+    updateModulation();
+
+    glitchDetector.setStep(sequencer.getCurrentStep());
+}
+
+void SynthController::loadDefaultModRoutes()
+{
+    modMatrix.clear();
+
+    // MUX0 ch0 stays on the BPM (read in loop()), ch1..12 drive the voice
+    modMatrix.addRoute(ModMatrix::muxSource(0, 1), ModMatrix::DST_VCO1_DETUNE, 25.0f);
+    modMatrix.addRoute(ModMatrix::muxSource(0, 2), ModMatrix::DST_VCO2_DETUNE, 25.0f);
+    modMatrix.addRoute(ModMatrix::muxSource(0, 3), ModMatrix::DST_VCO3_DETUNE, 25.0f);
+    modMatrix.addRoute(ModMatrix::muxSource(0, 4), ModMatrix::DST_VCO1_LEVEL, -1.0f);
+    modMatrix.addRoute(ModMatrix::muxSource(0, 5), ModMatrix::DST_VCO2_LEVEL, -1.0f);
+    modMatrix.addRoute(ModMatrix::muxSource(0, 6), ModMatrix::DST_VCO3_LEVEL, -1.0f);
+    modMatrix.addRoute(ModMatrix::muxSource(0, 7), ModMatrix::DST_ATTACK, 0.5f);
+    modMatrix.addRoute(ModMatrix::muxSource(0, 8), ModMatrix::DST_DECAY, 0.5f);
+    modMatrix.addRoute(ModMatrix::muxSource(0, 9), ModMatrix::DST_SUSTAIN, -1.0f);
+    modMatrix.addRoute(ModMatrix::muxSource(0, 10), ModMatrix::DST_RELEASE, 0.5f);
+    modMatrix.addRoute(ModMatrix::muxSource(0, 11), ModMatrix::DST_GATE_LENGTH, 1.0f);
+    modMatrix.addRoute(ModMatrix::muxSource(0, 12), ModMatrix::DST_TEMPO, 1.0f);
+
+    // Bowl wobble: slow, unrelated LFO rates so the beating never repeats exactly
+    lfoBank.setShape(0, LFOBank::SINE);
+    lfoBank.setRate(0, 0.23f);
+    lfoBank.setShape(1, LFOBank::TRIANGLE);
+    lfoBank.setRate(1, 0.37f);
+    lfoBank.setShape(2, LFOBank::SINE);
+    lfoBank.setRate(2, 0.11f);
+    lfoBank.setShape(3, LFOBank::SAMPLE_HOLD);
+    lfoBank.setRate(3, 0.5f);
+
+    modMatrix.addRoute(ModMatrix::SRC_LFO1, ModMatrix::DST_VCO2_DETUNE, 3.0f);
+    modMatrix.addRoute(ModMatrix::SRC_LFO2, ModMatrix::DST_VCO3_DETUNE, 4.0f);
+    modMatrix.addRoute(ModMatrix::SRC_LFO3, ModMatrix::DST_VCO2_LEVEL, 0.1f);
+    modMatrix.addRoute(ModMatrix::SRC_LFO3, ModMatrix::DST_VCO3_LEVEL, -0.1f);
+}
+
+void SynthController::updateModulation()
+{
+    if (!instrument)
+    {
+        return;
+    }
+
+    // Sources: 32 pots (12-bit ADC), the envelope and the LFO bank
+    if (muxController)
+    {
+        for (uint8_t i = 0; i < ModMatrix::NUM_MUX_CHANNELS; i++)
+        {
+            modMatrix.setSource(ModMatrix::SRC_MUX_FIRST + i, muxController->get(i / 16, i % 16) / 4095.0f);
+        }
+    }
+    modMatrix.setSource(ModMatrix::SRC_ENVELOPE, instrument->getEnvelopeLevel());
+
+    // LFOs advance by the real time elapsed since the previous block
+    uint32_t now = micros();
+    float dt = last_modulation_us ? (now - last_modulation_us) * 1e-6f : 0.0f;
+    last_modulation_us = now;
+    lfoBank.update(dt);
+    for (uint8_t i = 0; i < LFOBank::NUM_LFOS; i++)
+    {
+        modMatrix.setSource(ModMatrix::SRC_LFO1 + i, lfoBank.get(i));
+    }
+
+    modMatrix.process();
+
+    // Destinations (same offsets for every voice)
+    for (uint8_t v = 0; v < NUM_VOICES; v++)
+    {
+        voices[v]->setDetuneModulation(modMatrix.get(ModMatrix::DST_VCO1_DETUNE),
+                                       modMatrix.get(ModMatrix::DST_VCO2_DETUNE),
+                                       modMatrix.get(ModMatrix::DST_VCO3_DETUNE));
+        voices[v]->setLevelModulation(modMatrix.get(ModMatrix::DST_VCO1_LEVEL),
+                                      modMatrix.get(ModMatrix::DST_VCO2_LEVEL),
+                                      modMatrix.get(ModMatrix::DST_VCO3_LEVEL));
+        voices[v]->setADSRModulation(modMatrix.get(ModMatrix::DST_ATTACK),
+                                     modMatrix.get(ModMatrix::DST_DECAY),
+                                     modMatrix.get(ModMatrix::DST_SUSTAIN),
+                                     modMatrix.get(ModMatrix::DST_RELEASE));
+    }
+    sequencer.setGateScale(1.0f + modMatrix.get(ModMatrix::DST_GATE_LENGTH));
+    sequencer.setTempoScale(1.0f + modMatrix.get(ModMatrix::DST_TEMPO));
 }
 
 void SynthController::createJazzPattern(uint8_t numSteps, uint16_t bpm, uint16_t seedValue)
 {
-    Serial.println("Creating jazz pattern...");
+    LOG_PRINTLN("Creating jazz pattern...");
 
     if (seedValue == 0)
     {
@@ -89,6 +227,8 @@ void SynthController::createJazzPattern(uint8_t numSteps, uint16_t bpm, uint16_t
 
     sequencer.setBPM(bpm);
     sequencer.setNumSteps(numSteps);
+    sequencer.resetTracks();
+    sequencer.setTrackSwing(0, 62); // Between straight and triplet
     randomSeed(seedValue);
 
     for (uint8_t i = 0; i < numSteps; i++)
@@ -103,6 +243,10 @@ void SynthController::createJazzPattern(uint8_t numSteps, uint16_t bpm, uint16_t
             uint8_t gate = random(60, 70);      // Staccato feel
 
             sequencer.setStep(i, true, note, velocity, gate);
+
+            // Laid-back feel: up to ~5 ms late, a little less on the beat
+            int16_t late = (i % 4 == 0) ? random(0, 80) : random(40, 220);
+            sequencer.setStepMicroOffset(i, late);
         }
         else
         {
@@ -110,12 +254,12 @@ void SynthController::createJazzPattern(uint8_t numSteps, uint16_t bpm, uint16_t
         }
     }
 
-    Serial.printf("Jazz pattern created: %d steps at %d BPM\n", numSteps, bpm);
+    LOG_PRINTF("Jazz pattern created: %d steps at %d BPM\n", numSteps, bpm);
 }
 
 void SynthController::createAfricanPattern(uint8_t numSteps, uint16_t bpm, uint16_t seedValue)
 {
-    Serial.println("Creating African pattern...");
+    LOG_PRINTLN("Creating African pattern...");
 
     if (seedValue == 0)
     {
@@ -124,12 +268,13 @@ void SynthController::createAfricanPattern(uint8_t numSteps, uint16_t bpm, uint1
 
     sequencer.setBPM(bpm);
     sequencer.setNumSteps(numSteps);
+    sequencer.resetTracks();
     randomSeed(seedValue);
 
+    // Track 0: 4/4 bell pattern on the lead voice
     for (uint8_t i = 0; i < numSteps; i++)
     {
-        // African polyrhythm - complex rhythm patterns
-        bool active = (i % 3 != 2) || (random(100) < 35);
+        bool active = (i % 4 != 3) || (random(100) < 35);
 
         if (active)
         {
@@ -145,21 +290,35 @@ void SynthController::createAfricanPattern(uint8_t numSteps, uint16_t bpm, uint1
         }
     }
 
-    Serial.printf("African pattern created: %d steps at %d BPM\n", numSteps, bpm);
+    // Track 1: real 3 against 4 - 12 steps stretched over the same bar
+    // (ratio 4/3), accented every 4th step => 3 hits per bar
+    sequencer.setTrackVoice(1, voices[1]);
+    sequencer.setTrackLength(1, 12);
+    sequencer.setTrackRatio(1, 4, 3);
+    for (uint8_t i = 0; i < 12; i++)
+    {
+        bool active = (i % 4 == 0) || (random(100) < 20);
+        float note = range[22 + random(5)]; // Basses percutantes
+        uint8_t velocity = (i % 4 == 0) ? random(100, 128) : random(50, 80);
+        sequencer.setTrackStep(1, i, Sequencer::makeStep(active, note, velocity, random(40, 70)));
+    }
+
+    LOG_PRINTF("African pattern created: %d steps against 12 at %d BPM\n", numSteps, bpm);
 }
 // PATTERN ÉLECTRONIQUE
 void SynthController::createElectronicPattern(uint8_t numSteps, uint16_t bpm, uint16_t seedValue)
 {
-    Serial.println("Creating Electronic pattern...");
+    LOG_PRINTLN("Creating Electronic pattern...");
 
     if (seedValue == 0)
     {
         seedValue = analogRead(A0) + millis();
     }
-    Serial.printf("🎲 Random seed: %d\n", seedValue);
+    LOG_PRINTF("🎲 Random seed: %d\n", seedValue);
 
     sequencer.setBPM(bpm); // 120-140 BPM typique pour électronique
     sequencer.setNumSteps(numSteps);
+    sequencer.resetTracks();
     randomSeed(seedValue);
 
     for (uint8_t i = 0; i < numSteps; i++)
@@ -217,11 +376,13 @@ void SynthController::createElectronicPattern(uint8_t numSteps, uint16_t bpm, ui
         }
     }
 
-    Serial.printf("Electronic pattern created: %d steps at %d BPM\n", numSteps, bpm);
+    LOG_PRINTF("Electronic pattern created: %d steps at %d BPM\n", numSteps, bpm);
 }
 
 void SynthController::createTechnoPattern(uint8_t numSteps, uint16_t bpm)
 {
+    sequencer.resetTracks();
+
     // Pattern 4/4 classique techno
     for (uint8_t i = 0; i < numSteps; i++)
     {
@@ -248,6 +409,8 @@ void SynthController::createAcidPattern(uint8_t numSteps, uint16_t bpm)
     // Pattern acid house TB-303 style
     const float acid_notes[] = {N_A2, N_A2, N_E3, N_A3, N_C4, N_E4};
 
+    sequencer.resetTracks();
+
     for (uint8_t i = 0; i < numSteps; i++)
     {
         if (i % 2 == 0 || random(100) < 60)
@@ -256,7 +419,9 @@ void SynthController::createAcidPattern(uint8_t numSteps, uint16_t bpm)
             uint8_t velocity = random(60, 120);
             uint8_t gate = random(10, 80); // Variation slide/accent
 
-            sequencer.setStep(i, true, note, velocity, gate);
+            // Accent: the filter envelope sweeps further and snappier
+            uint8_t flags = random(100) < 25 ? Sequencer::Step::FLAG_ACCENT : 0;
+            sequencer.setStep(i, Sequencer::makeStep(true, note, velocity, gate, flags));
         }
     }
 }
@@ -264,16 +429,17 @@ void SynthController::createAcidPattern(uint8_t numSteps, uint16_t bpm)
 
 void SynthController::createBowlPattern(uint8_t numSteps, uint16_t bpm, uint16_t seedValue)
 {
-    Serial.println("Creating Tibetan Bowl pattern...");
+    LOG_PRINTLN("Creating Tibetan Bowl pattern...");
 
     if (seedValue == 0)
     {
         seedValue = analogRead(A0) + millis();
     }
-    Serial.printf("🎲 Random seed: %d\n", seedValue);
+    LOG_PRINTF("🎲 Random seed: %d\n", seedValue);
 
     sequencer.setBPM(bpm);
     sequencer.setNumSteps(numSteps);
+    sequencer.resetTracks();
     randomSeed(seedValue);
 
     // Bowl frequencies - focus on perfect 5ths and octaves for resonance
@@ -282,8 +448,8 @@ void SynthController::createBowlPattern(uint8_t numSteps, uint16_t bpm, uint16_t
 
     for (uint8_t i = 0; i < numSteps; i++)
     {
-        // African polyrhythm - complex rhythm patterns
-        bool active = (i % 3 != 2) || (random(100) < 15);
+        // 4-step phrasing on the lead bowl, the 3-step cycle lives on track 1
+        bool active = (i % 4 != 3) || (random(100) < 15);
 
         if (active)
         {
@@ -309,17 +475,129 @@ void SynthController::createBowlPattern(uint8_t numSteps, uint16_t bpm, uint16_t
         }
     }
 
-    Serial.printf("Bowl pattern created: %d steps at %d BPM\n", numSteps, bpm);
+    // Track 1: low drone bowl on a 3-step cycle, drifting against the 4-step phrase
+    // (modal voice: real inharmonic partials, long natural decay)
+    sequencer.setTrackVoice(1, &modalBowl);
+    sequencer.setTrackLength(1, 3);
+    sequencer.setTrackStep(1, 0, Sequencer::makeStep(true, range[random(0, 5)], random(30, 60), 95));
+    sequencer.setTrackStep(1, 1, Sequencer::makeStep(false, N_E1));
+    sequencer.setTrackStep(1, 2, Sequencer::makeStep(false, N_E1));
+
+    LOG_PRINTF("Bowl pattern created: %d steps at %d BPM\n", numSteps, bpm);
+}
+
+bool SynthController::setKey(uint8_t rootNote, Scale::Mode mode, const int8_t *chords, uint8_t numChords)
+{
+    // The mutator may be running on Core 0: take the generators first
+    if (!patternEngine.lockGenerators())
+    {
+        return false;
+    }
+
+    Scale scale;
+    scale.set(rootNote, mode);
+
+    PatternGenerator *generators[] = {&euclidean, &markov, &scaleWalk, &mutator};
+    for (PatternGenerator *generator : generators)
+    {
+        generator->setScale(scale);
+        generator->setChords(chords, chords ? numChords : 0);
+    }
+    patternEngine.unlockGenerators();
+
+    LOG_PRINTF("🎹 Key: note %d %s, %d chord(s)\n", rootNote, Scale::modeName(mode), chords ? numChords : 1);
+    return true;
+}
+
+bool SynthController::generateEuclidean(uint8_t hits, uint8_t pulses, uint8_t rotation, uint16_t numSteps, uint32_t seed)
+{
+    if (patternEngine.isBusy())
+    {
+        return false;
+    }
+
+    euclidean.setSeed(seed ? seed : analogRead(A0) + micros());
+    euclidean.setRhythm(hits, pulses, rotation);
+    glitchDetector.noteCommand("generate");
+    return patternEngine.request(&euclidean, numSteps);
+}
+
+bool SynthController::generateMarkov(uint16_t numSteps, uint32_t seed)
+{
+    if (patternEngine.isBusy())
+    {
+        return false;
+    }
+
+    markov.setSeed(seed ? seed : analogRead(A0) + micros());
+    glitchDetector.noteCommand("generate");
+    return patternEngine.request(&markov, numSteps);
+}
+
+bool SynthController::generateScaleWalk(uint16_t numSteps, uint8_t density, uint32_t seed)
+{
+    if (patternEngine.isBusy())
+    {
+        return false;
+    }
+
+    scaleWalk.setSeed(seed ? seed : analogRead(A0) + micros());
+    scaleWalk.setDensity(density);
+    glitchDetector.noteCommand("generate");
+    return patternEngine.request(&scaleWalk, numSteps);
+}
+
+bool SynthController::learnPattern()
+{
+    if (patternEngine.isBusy())
+    {
+        return false;
+    }
+
+    Sequencer::Step steps[PatternEngine::MAX_STEPS];
+    uint16_t count = min(sequencer.getNumSteps(), PatternEngine::MAX_STEPS);
+    for (uint16_t i = 0; i < count; i++)
+    {
+        steps[i] = sequencer.getStep(i);
+    }
+    markov.train(steps, count);
+    return true;
+}
+
+void SynthController::setEvolution(bool enable, uint8_t stepsPerBar, uint8_t rate)
+{
+    if (!enable)
+    {
+        patternEngine.setEvolution(nullptr);
+        LOG_PRINTLN("🧬 Evolution OFF");
+        return;
+    }
+
+    // Without the lock a pattern is on its way: no mutation runs before it lands
+    bool locked = patternEngine.lockGenerators();
+    mutator.setSeed(analogRead(A0) + micros());
+    mutator.setRate(stepsPerBar, rate);
+    if (locked)
+    {
+        patternEngine.unlockGenerators();
+    }
+    patternEngine.setEvolution(&mutator);
+    LOG_PRINTF("🧬 Evolution ON: up to %d step(s) per bar, %d%%\n", mutator.getMaxEdits(), rate);
 }
 
 void SynthController::setBPM(uint16_t bpm)
 {
+    // Called from the pot every loop: only actual changes are commands
+    if (bpm != sequencer.getBPM())
+    {
+        glitchDetector.noteCommand("bpm");
+    }
     sequencer.setBPM(bpm);
 }
 
 void SynthController::generateRandomPattern(uint8_t numSteps, uint16_t bpm, uint16_t seedValue)
 {
-    Serial.println("Generating random pattern...");
+    LOG_PRINTLN("Generating random pattern...");
 
     if (seedValue == 0)
     {
@@ -328,6 +606,7 @@ void SynthController::generateRandomPattern(uint8_t numSteps, uint16_t bpm, uint
 
     sequencer.setBPM(bpm);
     sequencer.setNumSteps(numSteps);
+    sequencer.resetTracks();
     randomSeed(seedValue);
 
     for (uint8_t i = 0; i < numSteps; i++)
@@ -348,7 +627,7 @@ void SynthController::generateRandomPattern(uint8_t numSteps, uint16_t bpm, uint
         }
     }
 
-    Serial.printf("Random pattern created: %d steps at %d BPM\n", numSteps, bpm);
+    LOG_PRINTF("Random pattern created: %d steps at %d BPM\n", numSteps, bpm);
 }
 
 
@@ -365,28 +644,34 @@ void SynthController::configureBowl(float attack, float decay, float sustain, fl
 {
     if (instrument)
     {
-        instrument->setADSR(attack, decay, sustain, release);
-        Serial.printf("Bowl ADSR configured: A=%.2f D=%.2f S=%.2f R=%.2f\n",
-                      attack, decay, sustain, release);
+        for (uint8_t v = 0; v < NUM_VOICES; v++)
+        {
+            voices[v]->setADSR(attack, decay, sustain, release);
+        }
+        LOG_PRINTF("Bowl ADSR configured: A=%.2f D=%.2f S=%.2f R=%.2f\n",
+                   attack, decay, sustain, release);
     }
 }
 
 void SynthController::playSequencer()
 {
+    glitchDetector.noteCommand("play");
     sequencer.play();
-    Serial.println("Sequencer started");
+    LOG_PRINTLN("Sequencer started");
 }
 
 void SynthController::stopSequencer()
 {
+    glitchDetector.noteCommand("stop");
     sequencer.stop();
-    Serial.println("Sequencer stopped");
+    LOG_PRINTLN("Sequencer stopped");
 }
 
 void SynthController::pauseSequencer()
 {
+    glitchDetector.noteCommand("pause");
     sequencer.pause();
-    Serial.println("Sequencer paused");
+    LOG_PRINTLN("Sequencer paused");
 }
 
 
@@ -406,11 +691,80 @@ void SynthController::initializeAudioComponents()
 
 void SynthController::setupVCOs(const String &style)
 {
+    glitchDetector.noteCommand("style");
+    current_style = style;
+    for (uint8_t v = 0; v < NUM_VOICES; v++)
+    {
+        voices[v]->setupVCOs(style);
+    }
 
-    instrument->setupVCOs(style);
+    // Room per style: long bloom for the bowls, short and dry for acid
+    if (style == "acid")
+    {
+        reverb.setDecay(1.2f);
+        reverb.setDamping(0.6f);
+        reverb.setMix(0.12f);
+    }
+    else if (style == "ambient")
+    {
+        reverb.setDecay(8.0f);
+        reverb.setDamping(0.5f);
+        reverb.setMix(0.4f);
+    }
+    else
+    {
+        reverb.setDecay(5.0f);
+        reverb.setDamping(0.35f);
+        reverb.setMix(0.3f);
+    }
+}
+
+bool SynthController::beginStorage(fs::FS &fs)
+{
+    if (!patternStore.begin(&sequencer, fs) || !sampler.begin(info))
+    {
+        return false;
+    }
+
+    // Sample layer: its own voice at the output rate, silent until loaded
+    renderStream.addVoice(&sampler);
+    return true;
+}
+
+bool SynthController::loadSample(fs::FS &fs, const char *path, float level, bool loop)
+{
+    if (!instrument || !sampler.open(fs, path, loop))
+    {
+        return false;
+    }
+
+    sampler.setLevel(level);
+    instrument->attachSampler(&sampler);
+    return true;
+}
+
+bool SynthController::savePattern(const char *path)
+{
+    return patternStore.save(path, PatternStore::styleFromName(current_style), sequencer.getBPM());
+}
+
+bool SynthController::loadPattern(const char *path)
+{
+    PatternStore::FileHeader header;
+    if (!patternStore.load(path, header))
+    {
+        return false;
+    }
+
+    // Songs play on track 0, apply the preset stored with the pattern
+    glitchDetector.noteCommand("load pattern");
+    sequencer.resetTracks();
+    setupVCOs(PatternStore::styleName(header.style));
+    sequencer.setBPM(header.bpm);
+    return true;
 }
 
 audio_tools::AudioStream *SynthController::getAudioStream()
 {
-    return instrument->getAudioStream(); // Toujours le bol
+    return &renderStream; // Toujours le bol (toutes les voix)
 }
@@ -3,8 +3,18 @@
 
 #include "Arduino.h"
 #include "AudioTools.h"
+#include <AudioConfig.h>
+#include <AsyncLog.h>
 #include <Sequencer.h>
 #include <Instrument.h>
+#include <ModalBowl.h>
+#include <ModMatrix.h>
+#include <LFOBank.h>
+#include <PatternStore.h>
+#include <PatternEngine.h>
+#include <RenderStream.h>
+#include <GlitchDetector.h>
+#include <MuxController.h>
 
 class SynthController
 {
@@ -16,9 +26,38 @@ private:
     // Sequencer
     Sequencer sequencer;
 
-    // Tibetan Bowl
+    // Voices: voice 0 is the lead Tibetan Bowl, the others serve the aux tracks
+    static const uint8_t NUM_VOICES = 2;
+    Instrument *voices[NUM_VOICES];
     Instrument *instrument;
-   
+
+    // Physically modelled bowl, plays the drone track
+    ModalBowl modalBowl;
+
+    // Output stage: sums the voices, sample-accurate sequencer events
+    RenderStream renderStream;
+    Reverb reverb;
+    MasterBus masterBus;
+    GlitchDetector glitchDetector;
+    WavRecorder recorder;
+
+    // Modulation matrix (hardware controls -> synth parameters)
+    ModMatrix modMatrix;
+    MuxController *muxController;
+    LFOBank lfoBank;
+    uint32_t last_modulation_us;
+
+    // Generative patterns, built on Core 0
+    PatternEngine patternEngine;
+    EuclideanGenerator euclidean;
+    MarkovGenerator markov;
+    ScaleWalkGenerator scaleWalk;
+    PatternMutator mutator;
+
+    // SD pattern/preset storage
+    PatternStore patternStore;
+    String current_style;
+    SamplePlayer sampler;
 
     // Audio configuration
     audio_tools::AudioInfo info;
@@ -57,17 +96,55 @@ public:
     void configureBowl(float attack = 0.1f, float decay = 0.2f, float sustain = 0.7f, float release = 8.0f);
     audio_tools::AudioStream *getAudioStream();
     // Getters for status
-    uint8_t getCurrentStep() const { return sequencer.getCurrentStep(); }
-    uint8_t getNumSteps() const { return sequencer.getNumSteps(); }
+    uint16_t getCurrentStep() const { return sequencer.getCurrentStep(); }
+    uint16_t getNumSteps() const { return sequencer.getNumSteps(); }
     uint16_t getBPM() const { return sequencer.getBPM(); }
     bool isPlaying() const { return sequencer.getState() == Sequencer::PLAYING; }
+    uint8_t getNumVoices() const { return NUM_VOICES; }
+    Instrument *getVoice(uint8_t index) { return index < NUM_VOICES ? voices[index] : nullptr; }
 
 
     // Dans SynthController.h - Ajouter dans la section public:
     void setupVCOs(const String &style);
+    Reverb &getReverb() { return reverb; }
+    MasterBus &getMasterBus() { return masterBus; }
+    RenderStream &getRenderStream() { return renderStream; }
+    ModalBowl &getModalBowl() { return modalBowl; }
+    GlitchDetector &getGlitchDetector() { return glitchDetector; }
+    WavRecorder &getRecorder() { return recorder; }
+
+    // Modulation
+    void setMuxController(MuxController *mux) { muxController = mux; }
+    ModMatrix &getModMatrix() { return modMatrix; }
+    LFOBank &getLFOBank() { return lfoBank; }
+    void loadDefaultModRoutes();
+
+    // Generative patterns: built on Core 0, swapped in on the next bar
+    bool setKey(uint8_t rootNote, Scale::Mode mode, const int8_t *chords = nullptr, uint8_t numChords = 0);
+    bool generateEuclidean(uint8_t hits, uint8_t pulses, uint8_t rotation = 0, uint16_t numSteps = 64, uint32_t seed = 0);
+    bool generateMarkov(uint16_t numSteps = 64, uint32_t seed = 0);
+    bool generateScaleWalk(uint16_t numSteps = 64, uint8_t density = 70, uint32_t seed = 0);
+    bool learnPattern(); // feed the current pattern to the Markov chain
+
+    // Evolution: a few steps of the playing pattern change every bar
+    void setEvolution(bool enable, uint8_t stepsPerBar = 4, uint8_t rate = 50);
+    bool isEvolving() const { return patternEngine.isEvolving(); }
+    PatternEngine &getPatternEngine() { return patternEngine; }
+
+    // Pattern storage (SD card)
+    bool beginStorage(fs::FS &fs);
+    bool savePattern(const char *path);
+    bool loadPattern(const char *path);
+    bool isStreamingPattern() const { return patternStore.isStreaming(); }
+    PatternStore &getPatternStore() { return patternStore; }
+
+    // Sample layer (SD card)
+    bool loadSample(fs::FS &fs, const char *path, float level = 0.5f, bool loop = false);
+    SamplePlayer &getSampler() { return sampler; }
 
 private:
     void initializeAudioComponents();
+    void updateModulation();
 };
 
 #endif // SYNTHCONTROLLER_H
\ No newline at end of file
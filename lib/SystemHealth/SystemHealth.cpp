@@ -0,0 +1,272 @@
+#include <SystemHealth.h>
+
+SystemHealth::SystemHealth()
+    : num_watched(0), num_previous(0), previous_total(0),
+      audio_lock(portMUX_INITIALIZER_UNLOCKED), sample_rate(AUDIO_SAMPLE_RATE),
+      audio_blocks(0), audio_late(0), audio_worst_load(0)
+{
+    memset(watched, 0, sizeof(watched));
+    memset(previous_handle, 0, sizeof(previous_handle));
+    memset(previous_runtime, 0, sizeof(previous_runtime));
+    memset(&report, 0, sizeof(report));
+}
+
+void SystemHealth::begin(uint32_t rate)
+{
+    sample_rate = rate;
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+    LOG_PRINTLN("🩺 SystemHealth: FreeRTOS run-time stats available");
+#else
+    LOG_PRINTLN("🩺 SystemHealth: no run-time stats in this core, stacks and heap only");
+#endif
+}
+
+void SystemHealth::watch(TaskHandle_t task, uint32_t stack_size)
+{
+    if (!task)
+    {
+        return;
+    }
+    for (uint8_t i = 0; i < num_watched; i++)
+    {
+        if (watched[i].handle == task)
+        {
+            watched[i].stack_size = stack_size;
+            return;
+        }
+    }
+    if (num_watched < MAX_WATCHED)
+    {
+        watched[num_watched].handle = task;
+        watched[num_watched].stack_size = stack_size;
+        num_watched++;
+    }
+}
+
+uint32_t SystemHealth::stackSizeOf(TaskHandle_t task) const
+{
+    for (uint8_t i = 0; i < num_watched; i++)
+    {
+        if (watched[i].handle == task)
+        {
+            return watched[i].stack_size;
+        }
+    }
+    return 0;
+}
+
+uint32_t SystemHealth::addAudioBlock(uint32_t busy_us, uint32_t frames)
+{
+    if (!frames)
+    {
+        return 0;
+    }
+
+    // Slower than real time: the block played out before the next was ready
+    uint32_t block_us = (uint64_t)frames * 1000000 / sample_rate;
+    float load = (float)busy_us / block_us;
+
+    portENTER_CRITICAL(&audio_lock);
+    audio_blocks++;
+    if (load > 1.0f)
+    {
+        audio_late++;
+    }
+    if (load > audio_worst_load)
+    {
+        audio_worst_load = load;
+    }
+    portEXIT_CRITICAL(&audio_lock);
+
+    return busy_us > block_us ? busy_us - block_us : 0;
+}
+
+void SystemHealth::readTasks()
+{
+    report.num_tasks = 0;
+
+#if configUSE_TRACE_FACILITY
+    // All tasks in one pass (the scheduler is suspended meanwhile: a few us)
+    TaskStatus_t status[MAX_TASKS];
+    uint32_t total = 0;
+    UBaseType_t count = uxTaskGetSystemState(status, MAX_TASKS, &total);
+
+#if configGENERATE_RUN_TIME_STATS
+    uint32_t elapsed = total - previous_total;
+    TaskHandle_t handles[MAX_TASKS];
+    uint32_t runtimes[MAX_TASKS];
+#endif
+
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        TaskReport &task = report.tasks[i];
+        strncpy(task.name, status[i].pcTaskName, NAME_SIZE - 1);
+        task.name[NAME_SIZE - 1] = 0;
+        task.state = status[i].eCurrentState;
+        task.priority = status[i].uxCurrentPriority;
+        task.stack_free = status[i].usStackHighWaterMark;
+        task.stack_size = stackSizeOf(status[i].xHandle);
+        task.cpu_percent = -1;
+
+#if configGENERATE_RUN_TIME_STATS
+        // Share of one core over the window: tasks are pinned, the counter
+        // runs per core
+        handles[i] = status[i].xHandle;
+        runtimes[i] = status[i].ulRunTimeCounter;
+        for (uint8_t p = 0; p < num_previous && previous_total; p++)
+        {
+            if (previous_handle[p] == handles[i] && elapsed)
+            {
+                task.cpu_percent = (runtimes[i] - previous_runtime[p]) * 100.0f / elapsed;
+                break;
+            }
+        }
+#endif
+    }
+    report.num_tasks = count;
+
+#if configGENERATE_RUN_TIME_STATS
+    memcpy(previous_handle, handles, count * sizeof(TaskHandle_t));
+    memcpy(previous_runtime, runtimes, count * sizeof(uint32_t));
+    num_previous = count;
+    previous_total = total;
+#endif
+
+    if (count)
+    {
+        return;
+    }
+#endif
+
+    // No trace facility (or more tasks than MAX_TASKS): the watched ones
+    for (uint8_t i = 0; i < num_watched; i++)
+    {
+        TaskReport &task = report.tasks[i];
+        strncpy(task.name, pcTaskGetName(watched[i].handle), NAME_SIZE - 1);
+        task.name[NAME_SIZE - 1] = 0;
+        task.state = eTaskGetState(watched[i].handle);
+        task.priority = uxTaskPriorityGet(watched[i].handle);
+        task.stack_free = uxTaskGetStackHighWaterMark(watched[i].handle);
+        task.stack_size = watched[i].stack_size;
+        task.cpu_percent = -1;
+    }
+    report.num_tasks = num_watched;
+}
+
+void SystemHealth::readHeap()
+{
+    report.heap_free = ESP.getFreeHeap();
+    report.heap_size = ESP.getHeapSize();
+    report.heap_min_free = ESP.getMinFreeHeap();
+    report.heap_largest = ESP.getMaxAllocHeap();
+    report.fragmentation = report.heap_free ? 1.0f - (float)report.heap_largest / report.heap_free : 0.0f;
+}
+
+const SystemHealth::Report &SystemHealth::read()
+{
+    readTasks();
+    readHeap();
+
+    portENTER_CRITICAL(&audio_lock);
+    report.audio_blocks = audio_blocks;
+    report.audio_late = audio_late;
+    report.audio_worst_load = audio_worst_load;
+    audio_worst_load = 0;
+    portEXIT_CRITICAL(&audio_lock);
+
+    return report;
+}
+
+const char *SystemHealth::stateName(eTaskState state)
+{
+    switch (state)
+    {
+    case eRunning:
+        return "running";
+    case eReady:
+        return "ready";
+    case eBlocked:
+        return "blocked";
+    case eSuspended:
+        return "suspended";
+    case eDeleted:
+        return "deleted";
+    default:
+        return "?";
+    }
+}
+
+void SystemHealth::print()
+{
+    read();
+
+    Serial.println("=== 🩺 SYSTEM HEALTH ===");
+    Serial.println("Task             State      Prio  CPU%   Stack free / size");
+    for (uint8_t i = 0; i < report.num_tasks; i++)
+    {
+        const TaskReport &task = report.tasks[i];
+        char cpu[8] = "   -";
+        if (task.cpu_percent >= 0)
+        {
+            snprintf(cpu, sizeof(cpu), "%5.1f", task.cpu_percent);
+        }
+        if (task.stack_size)
+        {
+            Serial.printf("%-16s %-10s %4u %6s  %5lu / %lu (%.0f%% used)\n",
+                          task.name, stateName(task.state), task.priority, cpu,
+                          (unsigned long)task.stack_free, (unsigned long)task.stack_size,
+                          100.0f * (task.stack_size - task.stack_free) / task.stack_size);
+        }
+        else
+        {
+            Serial.printf("%-16s %-10s %4u %6s  %5lu\n",
+                          task.name, stateName(task.state), task.priority, cpu,
+                          (unsigned long)task.stack_free);
+        }
+    }
+
+    Serial.printf("Heap: %lu free of %lu | min ever %lu | largest block %lu (%.0f%% fragmented)\n",
+                  (unsigned long)report.heap_free, (unsigned long)report.heap_size,
+                  (unsigned long)report.heap_min_free, (unsigned long)report.heap_largest,
+                  report.fragmentation * 100);
+    Serial.printf("Audio: %lu blocks | %lu late | worst load %.0f%%\n",
+                  (unsigned long)report.audio_blocks, (unsigned long)report.audio_late,
+                  report.audio_worst_load * 100);
+    Serial.println();
+}
+
+void SystemHealth::printSummary()
+{
+    read();
+
+    LOG_PRINTF("💾 Heap: %lu KB free | min %lu KB | largest block %lu KB (%.0f%% fragmented)\n",
+               (unsigned long)(report.heap_free / 1024), (unsigned long)(report.heap_min_free / 1024),
+               (unsigned long)(report.heap_largest / 1024), report.fragmentation * 100);
+
+    // Watched tasks only: the ones whose stack size is ours to tune
+    for (uint8_t i = 0; i < report.num_tasks; i++)
+    {
+        const TaskReport &task = report.tasks[i];
+        if (!task.stack_size)
+        {
+            continue;
+        }
+        if (task.cpu_percent >= 0)
+        {
+            LOG_PRINTF("🧵 %s: %s | CPU %.1f%% | stack %lu / %lu bytes free\n",
+                       task.name, stateName(task.state), task.cpu_percent,
+                       (unsigned long)task.stack_free, (unsigned long)task.stack_size);
+        }
+        else
+        {
+            LOG_PRINTF("🧵 %s: %s | stack %lu / %lu bytes free\n",
+                       task.name, stateName(task.state),
+                       (unsigned long)task.stack_free, (unsigned long)task.stack_size);
+        }
+    }
+
+    LOG_PRINTF("🎧 Audio: %lu late blocks of %lu | worst load %.0f%%\n",
+               (unsigned long)report.audio_late, (unsigned long)report.audio_blocks,
+               report.audio_worst_load * 100);
+}
@@ -0,0 +1,102 @@
+#ifndef SYSTEMHEALTH_H
+#define SYSTEMHEALTH_H
+
+#include "Arduino.h"
+#include <AudioConfig.h>
+#include <AsyncLog.h>
+
+// What the stack sizes, priorities and buffer sizes should be tuned from.
+//
+// Per task: state, priority, stack left (high-water mark, against the
+// stack size when the task was registered with watch()) and CPU share
+// since the previous read(), from the FreeRTOS run-time counters when the
+// core is built with them. Heap: free, minimum ever, largest block and
+// the fragmentation that follows. Audio: blocks that took longer to
+// render than to play (the DMA runs dry if that lasts), counted by the
+// audio task.
+class SystemHealth
+{
+public:
+    static const uint8_t MAX_TASKS = 24;
+    static const uint8_t MAX_WATCHED = 8;
+    static const uint8_t NAME_SIZE = 16;
+
+    struct TaskReport
+    {
+        char name[NAME_SIZE];
+        eTaskState state;
+        uint8_t priority;
+        uint32_t stack_free;  // bytes never used, since the task started
+        uint32_t stack_size;  // 0 when the task is not watched
+        float cpu_percent;    // of one core, since the previous read; < 0 if unknown
+    };
+
+    struct Report
+    {
+        uint8_t num_tasks;
+        TaskReport tasks[MAX_TASKS];
+
+        uint32_t heap_free;
+        uint32_t heap_size;
+        uint32_t heap_min_free;
+        uint32_t heap_largest;
+        float fragmentation; // 1 - largest block / free
+
+        uint32_t audio_blocks;
+        uint32_t audio_late;  // since boot
+        float audio_worst_load;
+    };
+
+private:
+    struct Watched
+    {
+        TaskHandle_t handle;
+        uint32_t stack_size;
+    };
+
+    Watched watched[MAX_WATCHED];
+    uint8_t num_watched;
+
+    // Run-time counters at the previous read()
+    TaskHandle_t previous_handle[MAX_TASKS];
+    uint32_t previous_runtime[MAX_TASKS];
+    uint8_t num_previous;
+    uint32_t previous_total;
+
+    // Audio side
+    mutable portMUX_TYPE audio_lock;
+    uint32_t sample_rate;
+    uint32_t audio_blocks;
+    uint32_t audio_late;
+    float audio_worst_load; // since the previous read()
+
+    Report report;
+
+public:
+    SystemHealth();
+
+    void begin(uint32_t rate);
+
+    // Stack sizes are not known to FreeRTOS: register them to get the usage
+    void watch(TaskHandle_t task, uint32_t stack_size);
+
+    // Audio task, after each block. Returns how late it was (0: in time)
+    uint32_t addAudioBlock(uint32_t busy_us, uint32_t frames);
+
+    // Control side: takes a new snapshot (CPU share since the previous one)
+    const Report &read();
+
+    // The whole snapshot as a table, on demand (straight to Serial, like
+    // the other dumps), and the lines worth a glance for the monitor (log)
+    void print();
+    void printSummary();
+
+    static const char *stateName(eTaskState state);
+
+private:
+    uint32_t stackSizeOf(TaskHandle_t task) const;
+    void readTasks();
+    void readHeap();
+};
+
+#endif // SYSTEMHEALTH_H
@@ -0,0 +1,91 @@
+#include <Telemetry.h>
+
+Telemetry::Telemetry()
+    : out(nullptr), sequence(0), sent(0), dropped(0)
+{
+}
+
+void Telemetry::begin(Print &output)
+{
+    out = &output;
+}
+
+uint8_t Telemetry::crc8(const uint8_t *data, size_t length)
+{
+    // CRC-8, polynomial 0x07: a frame is at most ~100 bytes, bitwise is enough
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+size_t Telemetry::cobsEncode(const uint8_t *src, size_t length, uint8_t *dst)
+{
+    // Each run of non-zero bytes is prefixed by its length + 1, which
+    // stands for the zero that ends it: no 0x00 left in the output
+    size_t code_index = 0;
+    size_t write_index = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        if (src[i] == 0)
+        {
+            dst[code_index] = code;
+            code_index = write_index++;
+            code = 1;
+        }
+        else
+        {
+            dst[write_index++] = src[i];
+            if (++code == 0xFF)
+            {
+                dst[code_index] = code;
+                code_index = write_index++;
+                code = 1;
+            }
+        }
+    }
+    dst[code_index] = code;
+    return write_index;
+}
+
+bool Telemetry::send(RecordType type, const void *payload, uint8_t length)
+{
+    if (!out || length > MAX_PAYLOAD)
+    {
+        return false;
+    }
+
+    uint32_t now = micros();
+    raw[0] = type;
+    raw[1] = sequence++;
+    raw[2] = now;
+    raw[3] = now >> 8;
+    raw[4] = now >> 16;
+    raw[5] = now >> 24;
+    memcpy(raw + HEADER_SIZE, payload, length);
+    size_t size = HEADER_SIZE + length;
+    raw[size] = crc8(raw, size);
+    size++;
+
+    encoded[0] = 0;
+    size_t frame = 1 + cobsEncode(raw, size, encoded + 1);
+    encoded[frame++] = 0;
+
+    // Never wait for the UART: the host sees the gap in the sequence
+    if (out->availableForWrite() < (int)frame)
+    {
+        dropped++;
+        return false;
+    }
+    out->write(encoded, frame);
+    sent++;
+    return true;
+}
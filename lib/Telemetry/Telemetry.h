@@ -0,0 +1,83 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "Arduino.h"
+
+// Binary telemetry frames over the serial port, decoded on the host by
+// tools/telemetry.py.
+//
+// A record is [type][sequence][timestamp_us, 4 bytes LE][payload][crc8],
+// COBS-encoded and written between two 0x00 delimiters in one write. Log
+// lines never contain 0x00, so text and frames share the UART: the host
+// prints what does not decode as a frame. A frame that does not fit in
+// the UART transmit buffer is dropped and counted, send() never waits.
+class Telemetry
+{
+public:
+    static const uint8_t MAX_PAYLOAD = 96;
+    static const uint8_t HEADER_SIZE = 6;
+    static const uint8_t NUM_CONTROLS = 32;
+    static const uint8_t MAX_VOICES = 4;
+
+    enum RecordType : uint8_t
+    {
+        CONTROLS = 1, // the 32 mux channels
+        VOICES = 2,   // envelope level and stage per voice
+        SYSTEM = 3    // DSP load, clock, sequencer position
+    };
+
+    // Payloads, little-endian as laid out in memory on the ESP32
+    struct __attribute__((packed)) Controls
+    {
+        uint16_t values[NUM_CONTROLS]; // raw 12-bit ADC
+    };
+
+    struct __attribute__((packed)) Voices
+    {
+        uint8_t count;
+        uint16_t level[MAX_VOICES]; // envelope level, 0..65535
+        uint8_t stage[MAX_VOICES];  // Envelope::Stage
+    };
+
+    struct __attribute__((packed)) System
+    {
+        uint16_t dsp_load;  // per mille of the block time
+        uint16_t cpu_mhz;
+        uint16_t step;
+        uint16_t num_steps;
+        uint16_t bpm;
+        uint8_t pattern;
+        uint8_t playing;
+    };
+
+private:
+    Print *out;
+    uint8_t sequence;
+    uint32_t sent;
+    uint32_t dropped;
+
+    // Single sender: one frame built at a time
+    uint8_t raw[HEADER_SIZE + MAX_PAYLOAD + 1];
+    uint8_t encoded[HEADER_SIZE + MAX_PAYLOAD + 1 + 2 + 2]; // + COBS overhead + delimiters
+
+public:
+    Telemetry();
+
+    void begin(Print &output);
+
+    // From one task only. False if the frame was dropped.
+    bool send(RecordType type, const void *payload, uint8_t length);
+
+    bool sendControls(const Controls &controls) { return send(CONTROLS, &controls, sizeof(controls)); }
+    bool sendVoices(const Voices &voices) { return send(VOICES, &voices, sizeof(voices)); }
+    bool sendSystem(const System &system) { return send(SYSTEM, &system, sizeof(system)); }
+
+    uint32_t getSent() const { return sent; }
+    uint32_t getDropped() const { return dropped; }
+
+    // Framing, mirrored by the host decoder
+    static size_t cobsEncode(const uint8_t *src, size_t length, uint8_t *dst);
+    static uint8_t crc8(const uint8_t *data, size_t length);
+};
+
+#endif // TELEMETRY_H
@@ -0,0 +1,90 @@
+#include <VCOMixer.h>
+
+VCOMixer::VCOMixer()
+    : info(defaultAudioInfo()), num_inputs(0)
+{
+    memset(inputs, 0, sizeof(inputs));
+    memset(weights, 0, sizeof(weights));
+    memset(gain_q15, 0, sizeof(gain_q15));
+    memset(current_q15, 0, sizeof(current_q15));
+}
+
+bool VCOMixer::begin(audio_tools::AudioInfo audioInfo)
+{
+    info = audioInfo;
+    if (info.bits_per_sample != 16 || info.channels > MAX_CHANNELS)
+    {
+        LOG_PRINTLN("Error: VCOMixer supports 16-bit mono/stereo only");
+        return false;
+    }
+    return true;
+}
+
+bool VCOMixer::add(audio_tools::AudioStream &stream, float weight)
+{
+    if (num_inputs >= MAX_INPUTS)
+    {
+        return false;
+    }
+    inputs[num_inputs] = &stream;
+    weights[num_inputs] = weight;
+    num_inputs++;
+    updateGains();
+
+    // A new input set starts at its gains, no ramp
+    memcpy(current_q15, gain_q15, sizeof(current_q15));
+    return true;
+}
+
+void VCOMixer::setWeight(uint8_t index, float weight)
+{
+    if (index >= num_inputs || weight == weights[index])
+    {
+        return;
+    }
+    weights[index] = weight;
+    updateGains();
+}
+
+void VCOMixer::updateGains()
+{
+    float total = 0;
+    for (uint8_t i = 0; i < num_inputs; i++)
+    {
+        total += weights[i];
+    }
+    for (uint8_t i = 0; i < num_inputs; i++)
+    {
+        gain_q15[i] = total > 0 ? (int32_t)(weights[i] / total * 32767) : 0;
+    }
+}
+
+size_t VCOMixer::readBytes(uint8_t *data, size_t len)
+{
+    int16_t *out = (int16_t *)data;
+    uint8_t channels = info.channels;
+    uint32_t frames = len / (sizeof(int16_t) * channels);
+    size_t bytes = frames * channels * sizeof(int16_t);
+
+    while (frames > 0)
+    {
+        uint32_t n = min(frames, (uint32_t)SCRATCH_FRAMES);
+        uint32_t samples = n * channels;
+        memset(accumulator, 0, samples * sizeof(int32_t));
+
+        for (uint8_t i = 0; i < num_inputs; i++)
+        {
+            // Every VCO is read, even at zero gain: its phase keeps running
+            uint32_t got = inputs[i]->readBytes((uint8_t *)scratch, samples * sizeof(int16_t)) / sizeof(int16_t);
+            DSPKernels::gainRamp(scratch, got / channels, channels, current_q15[i], gain_q15[i]);
+            DSPKernels::mixAccumulate(accumulator, scratch, got);
+            current_q15[i] = gain_q15[i];
+        }
+
+        DSPKernels::saturate16(accumulator, out, samples);
+        out += samples;
+        frames -= n;
+    }
+
+    return bytes;
+}
@@ -0,0 +1,54 @@
+#ifndef VCOMIXER_H
+#define VCOMIXER_H
+
+#include "Arduino.h"
+#include "AudioTools.h"
+#include <AudioConfig.h>
+#include <AsyncLog.h>
+#include <DSPKernels.h>
+
+// Weighted sum of the VCO streams, on the block kernels.
+//
+// Same result as InputMixer: each input is scaled by its weight over the
+// sum of the weights, so the mix never grows with the number of inputs.
+// Gains are Q15; a weight change (level modulation, once per block) ramps
+// over the next block instead of stepping, and the sum is 32-bit until
+// the final saturation.
+class VCOMixer : public audio_tools::AudioStream
+{
+public:
+    static const uint8_t MAX_INPUTS = 4;
+    static const uint16_t SCRATCH_FRAMES = 128;
+    static const uint8_t MAX_CHANNELS = 2;
+
+private:
+    audio_tools::AudioInfo info;
+    audio_tools::AudioStream *inputs[MAX_INPUTS];
+    float weights[MAX_INPUTS];
+    int32_t gain_q15[MAX_INPUTS];   // reached at the end of the next block
+    int32_t current_q15[MAX_INPUTS];
+    uint8_t num_inputs;
+
+    int16_t scratch[SCRATCH_FRAMES * MAX_CHANNELS];
+    int32_t accumulator[SCRATCH_FRAMES * MAX_CHANNELS];
+
+public:
+    VCOMixer();
+
+    bool begin(audio_tools::AudioInfo audioInfo);
+    void end() override { num_inputs = 0; }
+
+    // Weights are relative (InputMixer style, e.g. 0-100)
+    bool add(audio_tools::AudioStream &stream, float weight);
+    void setWeight(uint8_t index, float weight);
+
+    // AudioStream
+    size_t readBytes(uint8_t *data, size_t len) override;
+    size_t write(const uint8_t *data, size_t len) override { return 0; }
+    int available() override { return DEFAULT_BUFFER_SIZE; }
+
+private:
+    void updateGains();
+};
+
+#endif // VCOMIXER_H
@@ -0,0 +1,24 @@
+#ifndef VOICE_H
+#define VOICE_H
+
+#include "Arduino.h"
+#include "AudioTools.h"
+
+// What the sequencer needs from a voice: start and stop notes, and the
+// stream RenderStream reads the audio from.
+class Voice
+{
+public:
+    virtual ~Voice() {}
+
+    virtual void strike(float frequency, float velocity) = 0;
+    virtual void release() = 0;
+    virtual bool isActive() const = 0;
+    virtual audio_tools::AudioStream *getAudioStream() = 0;
+
+    // Called before strike() with the step's accent flag; voices without
+    // an accent response ignore it
+    virtual void setAccent(bool accented) {}
+};
+
+#endif // VOICE_H
@@ -0,0 +1,50 @@
+#ifndef WAVHEADER_H
+#define WAVHEADER_H
+
+#include "Arduino.h"
+
+// Canonical 44-byte header of a 16-bit PCM WAV file. The sizes can be
+// patched later by writing the header again at offset 0.
+class WavHeader
+{
+public:
+    static const uint8_t SIZE = 44;
+
+    static void fill(uint8_t *header, uint32_t sample_rate, uint8_t channels, uint32_t data_bytes)
+    {
+        uint16_t block_align = channels * sizeof(int16_t);
+
+        memcpy(header, "RIFF", 4);
+        put32(header + 4, 36 + data_bytes);
+        memcpy(header + 8, "WAVE", 4);
+
+        memcpy(header + 12, "fmt ", 4);
+        put32(header + 16, 16);
+        put16(header + 20, 1); // PCM
+        put16(header + 22, channels);
+        put32(header + 24, sample_rate);
+        put32(header + 28, sample_rate * block_align);
+        put16(header + 32, block_align);
+        put16(header + 34, 16);
+
+        memcpy(header + 36, "data", 4);
+        put32(header + 40, data_bytes);
+    }
+
+private:
+    static void put16(uint8_t *p, uint16_t value)
+    {
+        p[0] = value;
+        p[1] = value >> 8;
+    }
+
+    static void put32(uint8_t *p, uint32_t value)
+    {
+        p[0] = value;
+        p[1] = value >> 8;
+        p[2] = value >> 16;
+        p[3] = value >> 24;
+    }
+};
+
+#endif // WAVHEADER_H
@@ -0,0 +1,286 @@
+#include <WavRecorder.h>
+#include <new>
+
+WavRecorder::WavRecorder()
+    : ring(nullptr), ring_in_psram(false), sample_rate(AUDIO_SAMPLE_RATE), channels(2),
+      state(IDLE), capturing(false), task(NULL), fs(nullptr), next_index(0), file_open(false),
+      data_bytes(0), last_patch_ms(0), frames_written(0), overrun_frames(0), write_errors(0),
+      files(0), max_readable(0)
+{
+    base_path[0] = 0;
+    path[0] = 0;
+}
+
+WavRecorder::~WavRecorder()
+{
+    if (ring)
+    {
+        ring->~Ring();
+        free(ring);
+    }
+}
+
+void WavRecorder::begin(uint32_t rate, uint8_t numChannels)
+{
+    sample_rate = rate;
+    channels = numChannels;
+}
+
+bool WavRecorder::start(fs::FS &filesystem, const char *base)
+{
+    if (state != IDLE)
+    {
+        return false;
+    }
+
+    if (!ring)
+    {
+        // One allocation, kept for the next recordings
+        ring_in_psram = psramFound();
+        void *memory = ring_in_psram ? ps_malloc(sizeof(Ring)) : malloc(sizeof(Ring));
+        if (!memory)
+        {
+            LOG_PRINTLN("⚠️ WavRecorder: no memory for the ring");
+            return false;
+        }
+        ring = new (memory) Ring();
+        LOG_PRINTF("🎙️ Recorder ring: %lu KB in %s\n",
+                   (unsigned long)(sizeof(Ring) / 1024), ring_in_psram ? "PSRAM" : "RAM");
+    }
+
+    if (!task)
+    {
+        xTaskCreatePinnedToCore(
+            writerTask,
+            "WavWriter",
+            STACK_SIZE,
+            this,
+            1,
+            &task,
+            0 // Core 0
+        );
+        if (!task)
+        {
+            LOG_PRINTLN("⚠️ WavRecorder: cannot create the writer task");
+            return false;
+        }
+    }
+
+    // Neither side is using the ring while idle
+    ring->reset();
+    fs = &filesystem;
+    strncpy(base_path, base, PATH_SIZE - 9);
+    base_path[PATH_SIZE - 9] = 0;
+    next_index = 0;
+    frames_written = 0;
+    overrun_frames = 0;
+    write_errors = 0;
+    files = 0;
+    max_readable = 0;
+
+    // The writer opens the file, then turns the capture on
+    state = RECORDING;
+    return true;
+}
+
+void WavRecorder::stop()
+{
+    if (state == RECORDING)
+    {
+        capturing = false;
+        state = STOPPING;
+    }
+}
+
+WavRecorder::Stats WavRecorder::readStats() const
+{
+    Stats stats;
+    stats.frames_written = frames_written;
+    stats.overrun_frames = overrun_frames;
+    stats.write_errors = write_errors;
+    stats.files = files;
+    stats.max_fill = (uint8_t)(max_readable * 100 / RING_SAMPLES);
+    return stats;
+}
+
+void WavRecorder::write(const int16_t *samples, uint32_t frames)
+{
+    if (!capturing)
+    {
+        return;
+    }
+
+    // Whole block or nothing: the file stays frame-aligned
+    uint32_t total = frames * channels;
+    if (ring->writable() < total)
+    {
+        overrun_frames = overrun_frames + frames;
+        return;
+    }
+
+    while (total > 0)
+    {
+        uint32_t count;
+        int16_t *region = ring->writeRegion(count);
+        count = min(count, total);
+        memcpy(region, samples, count * sizeof(int16_t));
+        ring->commitWrite(count);
+        samples += count;
+        total -= count;
+    }
+}
+
+bool WavRecorder::openFile()
+{
+    // Never overwrite an earlier recording
+    bool found = false;
+    while (!found && next_index < 1000)
+    {
+        snprintf(path, PATH_SIZE, "%s%03u.wav", base_path, next_index++);
+        found = !fs->exists(path);
+    }
+    if (!found)
+    {
+        LOG_PRINTF("⚠️ No free recording name left for %s\n", base_path);
+        return false;
+    }
+
+    file = fs->open(path, FILE_WRITE);
+    if (!file)
+    {
+        LOG_PRINTF("⚠️ Cannot create recording %s\n", path);
+        return false;
+    }
+
+    // Empty header now, sizes patched as the data comes in
+    uint8_t header[WavHeader::SIZE];
+    WavHeader::fill(header, sample_rate, channels, 0);
+    file.write(header, sizeof(header));
+
+    file_open = true;
+    data_bytes = 0;
+    frames_written = 0;
+    last_patch_ms = millis();
+    files = files + 1;
+    LOG_PRINTF("🎙️ Recording to %s\n", path);
+    return true;
+}
+
+void WavRecorder::patchHeader()
+{
+    uint8_t header[WavHeader::SIZE];
+    WavHeader::fill(header, sample_rate, channels, data_bytes);
+    file.seek(0);
+    file.write(header, sizeof(header));
+    file.seek(WavHeader::SIZE + data_bytes);
+    file.flush();
+    last_patch_ms = millis();
+}
+
+void WavRecorder::closeFile()
+{
+    patchHeader();
+    file.close();
+    file_open = false;
+    LOG_PRINTF("🎙️ Closed %s: %lu s\n", path, (unsigned long)(frames_written / sample_rate));
+}
+
+bool WavRecorder::writeBatch(uint32_t max_samples)
+{
+    uint32_t count;
+    const int16_t *region = ring->readRegion(count);
+    count = min(count, max_samples);
+
+    uint32_t bytes = count * sizeof(int16_t);
+    if (data_bytes + bytes > MAX_FILE_BYTES)
+    {
+        closeFile();
+        if (!openFile())
+        {
+            return false;
+        }
+    }
+
+    if (file.write((const uint8_t *)region, bytes) != bytes)
+    {
+        write_errors = write_errors + 1;
+        return false;
+    }
+    ring->commitRead(count);
+    data_bytes += bytes;
+    frames_written = frames_written + count / channels;
+    return true;
+}
+
+void WavRecorder::run()
+{
+    while (true)
+    {
+        if (state == IDLE)
+        {
+            vTaskDelay(pdMS_TO_TICKS(50));
+            continue;
+        }
+
+        if (!file_open)
+        {
+            // stop() before the file was even opened: nothing was captured
+            if (state == STOPPING)
+            {
+                capturing = false;
+                state = IDLE;
+                continue;
+            }
+            if (!openFile())
+            {
+                state = IDLE;
+                continue;
+            }
+            // Unless stop() came meanwhile
+            capturing = state == RECORDING;
+        }
+
+        uint32_t readable = ring->readable();
+        if (readable > max_readable)
+        {
+            max_readable = readable;
+        }
+
+        // Large writes only, except for what is left at the end
+        bool stopping = state == STOPPING;
+        if (readable >= WRITE_BATCH || (stopping && readable > 0))
+        {
+            if (!writeBatch(WRITE_BATCH))
+            {
+                // Card full or gone: keep what was written
+                LOG_PRINTF("⚠️ Recording stopped: write error on %s\n", path);
+                capturing = false;
+                if (file_open)
+                {
+                    closeFile();
+                }
+                state = IDLE;
+            }
+            continue;
+        }
+
+        if (stopping)
+        {
+            capturing = false;
+            closeFile();
+            state = IDLE;
+            continue;
+        }
+
+        if (millis() - last_patch_ms >= HEADER_PATCH_MS)
+        {
+            patchHeader();
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+void WavRecorder::writerTask(void *parameter)
+{
+    static_cast<WavRecorder *>(parameter)->run();
+}
@@ -0,0 +1,104 @@
+#ifndef WAVRECORDER_H
+#define WAVRECORDER_H
+
+#include "Arduino.h"
+#include "FS.h"
+#include <AudioConfig.h>
+#include <AsyncLog.h>
+#include <SPSCRing.h>
+#include <WavHeader.h>
+
+// Records the live output to SD as 16-bit WAV files, for hours.
+//
+// The audio task tees every output block into a lock-free ring (one
+// memcpy, never waits: a block that does not fit is dropped and counted
+// as an overrun). A writer task on Core 0 owns the file: it writes the
+// ring in WRITE_BATCH chunks (large sequential writes are what SD cards
+// are fast at), rewrites the header every HEADER_PATCH_MS so a file cut
+// by a power loss still plays up to the last patch, and starts a new
+// file every MAX_FILE_BYTES (FAT32 and WAV both stop at 4 GB).
+//
+// The ring is allocated on the first start(), in PSRAM when present.
+class WavRecorder
+{
+public:
+    static const uint32_t RING_SAMPLES = 32768;   // 64 KB, ~370 ms of 44.1 kHz stereo
+    static const uint32_t WRITE_BATCH = 8192;     // samples per write (16 KB)
+    static const uint32_t HEADER_PATCH_MS = 5000;
+    static const uint32_t MAX_FILE_BYTES = 1024UL * 1024 * 1024; // ~100 min of 44.1 kHz stereo
+    static const uint32_t STACK_SIZE = 4096;
+    static const uint8_t PATH_SIZE = 32;
+
+    enum State : uint8_t
+    {
+        IDLE,
+        RECORDING,
+        STOPPING
+    };
+
+    struct Stats
+    {
+        uint32_t frames_written; // current file
+        uint32_t overrun_frames; // dropped since start()
+        uint32_t write_errors;
+        uint16_t files;          // opened since start()
+        uint8_t max_fill;        // ring high-water mark, percent
+    };
+
+private:
+    typedef SPSCRing<int16_t, RING_SAMPLES> Ring;
+
+    Ring *ring;
+    bool ring_in_psram;
+    uint32_t sample_rate;
+    uint8_t channels;
+
+    volatile State state;
+    volatile bool capturing; // audio side pushes into the ring
+    TaskHandle_t task;
+
+    // Writer side
+    fs::FS *fs;
+    char base_path[PATH_SIZE];
+    char path[PATH_SIZE];
+    uint16_t next_index;
+    File file;
+    bool file_open;
+    uint32_t data_bytes;
+    uint32_t last_patch_ms;
+
+    // Statistics
+    volatile uint32_t frames_written;
+    volatile uint32_t overrun_frames;
+    volatile uint32_t write_errors;
+    volatile uint16_t files;
+    volatile uint32_t max_readable;
+
+public:
+    WavRecorder();
+    ~WavRecorder();
+
+    void begin(uint32_t rate, uint8_t numChannels);
+
+    // Control side. Files are <base>000.wav, <base>001.wav...
+    bool start(fs::FS &filesystem, const char *base);
+    void stop(); // the writer drains the ring and closes the file
+
+    State getState() const { return state; }
+    bool isRecording() const { return state != IDLE; }
+    const char *getPath() const { return path; }
+    Stats readStats() const;
+
+    // Audio task: tee of the final interleaved output
+    void write(const int16_t *samples, uint32_t frames);
+
+private:
+    bool openFile();
+    void closeFile();
+    void patchHeader();
+    bool writeBatch(uint32_t max_samples);
+    void run();
+    static void writerTask(void *parameter);
+};
+
+#endif // WAVRECORDER_H
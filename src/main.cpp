@@ -7,13 +7,16 @@
 #include <MuxController.h>
 #include <DriverUDA1334A.h>
 #include <SynthController.h>
+#include <PowerManager.h>
+#include <Telemetry.h>
+#include <SystemHealth.h>
 
 #define I2S_DOUT 25
 #define I2S_BCLK 27
 #define I2S_LRC 26
 
-// Audio configuration
-AudioInfo info(44100, 2, 16);
+// Audio configuration (sample rate and oversampling: see AudioConfig.h)
+AudioInfo info = defaultAudioInfo();
 
 // Driver UDA1334A (already contains I2SStream)
 DriverUDA1334A driverUDA1334A;
@@ -26,9 +29,28 @@ SynthController synthesizer;
 
 MuxController muxController;
 
+// CPU clock follows the audio task's DSP load
+PowerManager powerManager;
+
+// Binary telemetry for tools/telemetry.py, which then replaces the
+// serial monitor (it prints the log lines between the frames)
+Telemetry telemetry;
+bool telemetryMode = false;
+const uint32_t TELEMETRY_PERIOD_MS = 20; // 50 frames/s of each record
+
+// Task, heap and audio deadline statistics ('h' on the serial port)
+SystemHealth health;
+
+// Task stack sizes (bytes), checked by SystemHealth
+const uint32_t AUDIO_TASK_STACK = 4096;
+const uint32_t MUX_TASK_STACK = 4096;
+const uint32_t TELEMETRY_TASK_STACK = 3072;
+const uint32_t LOOP_TASK_STACK = 8192; // Arduino core default
+
 // FreeRTOS task handles
 TaskHandle_t audioTaskHandle = NULL;
 TaskHandle_t muxTaskHandle = NULL;
+TaskHandle_t telemetryTaskHandle = NULL;
 
 volatile bool audioRunning = false;
 
@@ -39,6 +61,7 @@ enum PatternType
   PATTERN_ELECTRONIC,
   PATTERN_TECHNO,
   PATTERN_ACID,
+  PATTERN_GENERATIVE,
   PATTERN_COUNT
 };
 
@@ -46,23 +69,54 @@ PatternType currentPattern = PATTERN_BOWL;
 unsigned long lastPatternChange = 0;
 const unsigned long PATTERN_CHANGE_INTERVAL = 30000; // 20 secondes
 
+// Song mode: a pattern file on SD replaces the automatic pattern switching
+const char *SONG_FILE = "/song.gmp";
+bool songMode = false;
+const int BPM_POT_DEADBAND = 24; // raw units, ~3 BPM
+
+// Evolution mode: the pattern mutates a few steps per bar, and the
+// rotation slows down to EVOLVE_CHANGE_INTERVAL so each pattern has time
+// to drift. The generative slot is swapped in on a bar line (no
+// stop/start); the written patterns still restart
+bool evolveMode = true;
+const unsigned long EVOLVE_CHANGE_INTERVAL = 120000;
+
+// Optional sample layered with the VCOs
+const char *SAMPLE_FILE = "/bowl.wav";
+
+// SD card present: glitch snapshots are saved as /glitchNNN.wav
+bool storageReady = false;
+uint16_t glitchFiles = 0;
+
+// Installation capture: record the output to /recNNN.wav from boot
+// ('r' on the serial port starts/stops it at any time)
+bool recordMode = false;
+const char *RECORD_BASE = "/rec";
+
+// Boot-time cost of one voice in this build's mode (SYNTH_OVERSAMPLING):
+// flash each mode and compare the lines
+bool benchmarkMode = false;
+const uint16_t BENCHMARK_BLOCKS = 200;
+const uint16_t BENCHMARK_FRAMES = 256;
+
 // Pattern names for debug
 const char *patternNames[] = {
     "Tibetan Bowl",
     "Electronic",
     "Techno",
-    "Acid House"};
+    "Acid House",
+    "Generative"};
 
 /**
  * AUDIO TASK - High priority
  */
 void audioTask(void *parameter)
 {
-  Serial.println("Audio Task started on Core " + String(xPortGetCoreID()));
+  LOG_PRINTF("Audio Task started on Core %d\n", xPortGetCoreID());
 
   if (!copier)
   {
-    Serial.println("Error: copier not initialized");
+    LOG_PRINTLN("Error: copier not initialized");
     vTaskDelete(NULL);
     return;
   }
@@ -72,28 +126,77 @@ void audioTask(void *parameter)
   while (audioRunning)
   {
     // Update synthesizer (includes sequencer)
+    uint32_t updateStart = micros();
     synthesizer.update();
+    uint32_t updateUs = micros() - updateStart;
 
     // Continuous audio stream copy
     copier->copy();
 
+    // DSP time only (the copy also waits for the I2S DMA)
+    uint32_t renderUs, renderFrames;
+    synthesizer.getRenderStream().takeRenderTime(renderUs, renderFrames);
+    powerManager.update(updateUs + renderUs, renderFrames);
+    uint32_t lateUs = health.addAudioBlock(updateUs + renderUs, renderFrames);
+    if (lateUs)
+    {
+      synthesizer.getGlitchDetector().addUnderrun(lateUs);
+    }
+
     // Small yield to avoid monopolizing CPU
     // 1ms
     vTaskDelay(1);
   }
 
-  Serial.println("Audio Task terminated");
+  LOG_PRINTLN("Audio Task terminated");
   vTaskDelete(NULL);
 }
 
-void plotValues(uint8_t id, uint16_t value)
+/**
+ * TELEMETRY TASK - Low priority, Core 0
+ * Samples the controls, voices and DSP state and sends them as binary
+ * frames (~6 KB/s at 50 Hz, half of the 115200 baud link)
+ */
+void telemetryTask(void *parameter)
 {
-  Serial.print('>');
-  Serial.print(id);
-  Serial.print(':');
-  Serial.print(value);
-  Serial.println();
-  Serial.flush();
+  TickType_t lastWake = xTaskGetTickCount();
+
+  while (true)
+  {
+    Telemetry::Controls controls;
+    for (uint8_t i = 0; i < Telemetry::NUM_CONTROLS; i++)
+    {
+      controls.values[i] = muxController.get(i / 16, i % 16);
+    }
+    telemetry.sendControls(controls);
+
+    Telemetry::Voices voices;
+    memset(&voices, 0, sizeof(voices));
+    voices.count = synthesizer.getNumVoices();
+    if (voices.count > Telemetry::MAX_VOICES)
+    {
+      voices.count = Telemetry::MAX_VOICES;
+    }
+    for (uint8_t v = 0; v < voices.count; v++)
+    {
+      Instrument *voice = synthesizer.getVoice(v);
+      voices.level[v] = (uint16_t)(constrain(voice->getEnvelopeLevel(), 0.0f, 1.0f) * 65535);
+      voices.stage[v] = voice->getEnvelopeStage();
+    }
+    telemetry.sendVoices(voices);
+
+    Telemetry::System system;
+    system.dsp_load = (uint16_t)constrain(powerManager.getLoad() * 1000, 0.0f, 65535.0f);
+    system.cpu_mhz = powerManager.getFrequencyMhz();
+    system.step = synthesizer.getCurrentStep();
+    system.num_steps = synthesizer.getNumSteps();
+    system.bpm = synthesizer.getBPM();
+    system.pattern = currentPattern;
+    system.playing = synthesizer.isPlaying();
+    telemetry.sendSystem(system);
+
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(TELEMETRY_PERIOD_MS));
+  }
 }
 
 /**
@@ -101,7 +204,7 @@ void plotValues(uint8_t id, uint16_t value)
  */
 void muxTask(void *parameter)
 {
-  Serial.println("Multiplexer Task started on Core " + String(xPortGetCoreID()));
+  LOG_PRINTF("Multiplexer Task started on Core %d\n", xPortGetCoreID());
 
   while (true)
   {
@@ -118,17 +221,26 @@ void muxTask(void *parameter)
  */
 void switchToNextPattern()
 {
-  // Stop current pattern
-  synthesizer.stopSequencer();
+  // The generative pattern learns from everything played before it
+  synthesizer.learnPattern();
+
+  // Stop current pattern (a generated one replaces it on the next bar)
+  bool generative = (currentPattern + 1) % PATTERN_COUNT == PATTERN_GENERATIVE;
+  if (!generative)
+  {
+    synthesizer.stopSequencer();
+  }
 
   // Move to next pattern
   currentPattern = (PatternType)((currentPattern + 1) % PATTERN_COUNT);
+  synthesizer.getGlitchDetector().setPattern(currentPattern);
+  synthesizer.getGlitchDetector().noteCommand("pattern switch");
 
   // Generate random seed
   uint16_t seed = analogRead(A0) + millis() + muxController.get(0, 0);
 
-  Serial.printf("🎵 Switching to pattern: %s (seed: %d)\n",
-                patternNames[currentPattern], seed);
+  LOG_PRINTF("🎵 Switching to pattern: %s (seed: %d)\n",
+             patternNames[currentPattern], seed);
 
   uint16_t rawValue = muxController.get(0, 0);
   uint16_t bpm = map(rawValue, 0, 1500, 16, 200);
@@ -160,61 +272,144 @@ void switchToNextPattern()
     synthesizer.setupVCOs("ambient");
     synthesizer.createAcidPattern(64, bpm);
     break;
+
+  case PATTERN_GENERATIVE:
+  {
+    // Chords on degrees I - VI - IV - V, key picked from the seed (A1..G#2)
+    static const int8_t chords[] = {0, 5, 3, 4};
+    synthesizer.setupVCOs("ambient");
+    synthesizer.setBPM(bpm);
+    if (!synthesizer.setKey(21 + seed % 12, (Scale::Mode)(seed % Scale::MODE_COUNT), chords, 4) ||
+        !synthesizer.generateMarkov(64, seed))
+    {
+      LOG_PRINTLN("⚠️ Generator busy, the current pattern keeps playing");
+    }
+    break;
+  }
   }
 
   // Start playing new pattern
-  synthesizer.playSequencer();
+  if (!generative)
+  {
+    synthesizer.playSequencer();
+  }
 
-  Serial.printf("✓ Pattern '%s' started\n", patternNames[currentPattern]);
+  LOG_PRINTF("✓ Pattern '%s' started\n", patternNames[currentPattern]);
 }
 
 void setupAudio()
 {
-  Serial.println("Audio initialization...");
+  LOG_PRINTLN("Audio initialization...");
 
   // Initialize driver UDA1334A
   if (!driverUDA1334A.begin(info))
   {
-    Serial.println("Error: Cannot initialize UDA1334A");
+    LOG_PRINTLN("Error: Cannot initialize UDA1334A");
+    return;
+  }
+
+  LOG_PRINTLN("Audio initialized successfully");
+  LOG_PRINTF("🎚️ Audio: %lu Hz, VCOs %s\n", (unsigned long)info.sample_rate,
+             AUDIO_OVERSAMPLING > 1 ? "2x oversampled (half-band decimator)" : "at output rate");
+
+  // Starts at 240 MHz, scales down once the audio task reports its load
+  powerManager.begin(info.sample_rate);
+  health.begin(info.sample_rate);
+}
+
+void benchmarkVoice()
+{
+  // A voice of its own, before the audio task exists: nothing else runs
+  static int16_t block[BENCHMARK_FRAMES * AUDIO_CHANNELS];
+  Instrument *voice = new Instrument();
+  if (!voice->begin(info))
+  {
+    delete voice;
     return;
   }
+  voice->setupVCOs("tibetan");
+  voice->strike(220.0f, 1.0f);
 
-  Serial.println("Audio initialized successfully");
+  uint32_t start = micros();
+  for (uint16_t b = 0; b < BENCHMARK_BLOCKS; b++)
+  {
+    voice->getAudioStream()->readBytes((uint8_t *)block, sizeof(block));
+  }
+  uint32_t elapsed = micros() - start;
+  delete voice;
+
+  float block_us = BENCHMARK_FRAMES * 1000000.0f / info.sample_rate;
+  LOG_PRINTF("⏱️ Voice cost, oversampling x%u: %.0f us per %u-frame block (%.1f%% of real time)\n",
+             AUDIO_OVERSAMPLING, (float)elapsed / BENCHMARK_BLOCKS, BENCHMARK_FRAMES,
+             elapsed * 100.0f / (BENCHMARK_BLOCKS * block_us));
+}
+
+void setupStorage()
+{
+  SPI.begin(SPI_SCK, SPI_MISO, SPI_MOSI);
+  if (!SD.begin(SD_CS))
+  {
+    LOG_PRINTLN("⚠️ No SD card - patterns stay in RAM");
+    return;
+  }
+  storageReady = true;
+
+  synthesizer.beginStorage(SD);
+
+  if (SD.exists(SAMPLE_FILE))
+  {
+    synthesizer.loadSample(SD, SAMPLE_FILE, 0.5f);
+  }
+
+  if (SD.exists(SONG_FILE) && synthesizer.loadPattern(SONG_FILE))
+  {
+    songMode = true;
+    LOG_PRINTF("📀 Song mode: playing %s\n", SONG_FILE);
+  }
 }
 
 void setupSynthesizer()
 {
-  // Initialize synthesizer
+  // Initialize synthesizer (pots feed the modulation matrix)
+  synthesizer.setMuxController(&muxController);
   if (!synthesizer.begin(info))
   {
-    Serial.println("Error: Cannot initialize synthesizer");
+    LOG_PRINTLN("Error: Cannot initialize synthesizer");
     return;
   }
 
-  // Start with Bowl pattern
-
-  synthesizer.createBowlPattern(64, 30, analogRead(A0) + millis() + muxController.get(0, 0));
+  // Start with Bowl pattern (or the song found on SD)
+  setupStorage();
+  if (!songMode)
+  {
+    synthesizer.createBowlPattern(64, 30, analogRead(A0) + millis() + muxController.get(0, 0));
+  }
 
   copier = new StreamCopy(driverUDA1334A.getStream(), *synthesizer.getAudioStream());
 
-  Serial.println("Creating initial synthesizer pattern...");
+  LOG_PRINTLN("Creating initial synthesizer pattern...");
 
   // Start playing immediately
   synthesizer.playSequencer();
 
+  if (evolveMode && !songMode)
+  {
+    synthesizer.setEvolution(true, 4, 50);
+  }
+
   // Initialize pattern switching timer
   lastPatternChange = millis();
 }
 
 void setupTasks()
 {
-  Serial.println("Creating FreeRTOS tasks...");
+  LOG_PRINTLN("Creating FreeRTOS tasks...");
 
   // Audio Task - High priority, Core 1 (dedicated)
   xTaskCreatePinnedToCore(
       audioTask,        // Function
       "AudioTask",      // Name
-      4096,             // Stack size
+      AUDIO_TASK_STACK, // Stack size
       NULL,             // Parameters
       3,                // High priority (0-5, 5=max)
       &audioTaskHandle, // Handle
@@ -225,35 +420,61 @@ void setupTasks()
   xTaskCreatePinnedToCore(
       muxTask,
       "MuxTask",
-      4096,
+      MUX_TASK_STACK,
       NULL,
       1, // normal priority
       &muxTaskHandle,
       0 // Core 0
   );
 
+  // Telemetry Task - Low priority, Core 0 (below the mux scan)
+  if (telemetryMode)
+  {
+    telemetry.begin(Serial);
+    xTaskCreatePinnedToCore(
+        telemetryTask,
+        "TelemetryTask",
+        TELEMETRY_TASK_STACK,
+        NULL,
+        0,
+        &telemetryTaskHandle,
+        0 // Core 0
+    );
+  }
+
+  health.watch(audioTaskHandle, AUDIO_TASK_STACK);
+  health.watch(muxTaskHandle, MUX_TASK_STACK);
+  health.watch(telemetryTaskHandle, TELEMETRY_TASK_STACK);
+  health.watch(asyncLog.getTask(), AsyncLog::STACK_SIZE);
+  health.watch(xTaskGetCurrentTaskHandle(), LOOP_TASK_STACK);
+
   if (audioTaskHandle && muxTaskHandle)
   {
-    Serial.println("✓ Tasks created successfully");
-    Serial.println("  - AudioTask: Core 1, Priority 3");
-    Serial.println("  - MuxTask: Core 0, Priority 1");
+    LOG_PRINTLN("✓ Tasks created successfully");
+    LOG_PRINTLN("  - AudioTask: Core 1, Priority 3");
+    LOG_PRINTLN("  - MuxTask: Core 0, Priority 1");
   }
   else
   {
-    Serial.println("✗ Task creation error");
+    LOG_PRINTLN("✗ Task creation error");
   }
 }
 
 void setup()
 {
+  // Room for a few frames/lines: writers check the space instead of waiting
+  Serial.setTxBufferSize(2048);
   Serial.begin(115200);
 
+  // Everything printed from here on goes through the log task
+  asyncLog.begin();
+
   WiFi.disconnect(true);
   WiFi.mode(WIFI_OFF);
 
   // wait for serial to stabilize
   delay(1000);
-  Serial.println("\n=== ESP32 Audio Synthesizer with Auto Pattern Switching ===\n");
+  LOG_PRINTLN("\n=== ESP32 Audio Synthesizer with Auto Pattern Switching ===\n");
 
   // Setup ADC
   analogSetWidth(12);
@@ -261,6 +482,10 @@ void setup()
 
   // Setup audio and synthesizer
   setupAudio();
+  if (benchmarkMode)
+  {
+    benchmarkVoice();
+  }
 
   // Setup synthesizer pattern
   setupSynthesizer();
@@ -268,23 +493,81 @@ void setup()
   // create tasks
   setupTasks();
 
-  Serial.println("Setup completed. Auto pattern switching every 20s.\n");
+  // Installation capture from boot
+  if (recordMode && storageReady)
+  {
+    synthesizer.getRecorder().start(SD, RECORD_BASE);
+  }
+
+  LOG_PRINTLN("Setup completed. Auto pattern switching every 20s.\n");
 }
 
-// Memory formatting utility function
-String formatMemory(uint32_t bytes)
+/**
+ * RECORDING
+ */
+void toggleRecording()
 {
-  if (bytes >= 1024 * 1024)
+  WavRecorder &recorder = synthesizer.getRecorder();
+  if (recorder.isRecording())
   {
-    return String(bytes / 1024.0 / 1024.0, 1) + " MB";
+    recorder.stop();
+    LOG_PRINTLN("🎙️ Recording stopping...");
   }
-  else if (bytes >= 1024)
+  else if (!storageReady)
   {
-    return String(bytes / 1024.0, 1) + " KB";
+    LOG_PRINTLN("⚠️ No SD card - cannot record");
   }
-  else
+  else if (!recorder.start(SD, RECORD_BASE))
   {
-    return String(bytes) + " B";
+    LOG_PRINTLN("⚠️ Recording not started");
+  }
+}
+
+/**
+ * GLITCH REPORT
+ * One line per event; the audio around the first one goes to SD
+ */
+void reportGlitches()
+{
+  GlitchDetector &detector = synthesizer.getGlitchDetector();
+
+  GlitchDetector::Event event;
+  while (detector.readEvent(event))
+  {
+    LOG_PRINTF("💥 Glitch: %s (%ld) at frame %lu | step %d | %s | after \"%s\" +%lu ms%s\n",
+               GlitchDetector::typeName(event.type),
+               (long)event.value,
+               (unsigned long)event.frame,
+               event.step + 1,
+               patternNames[event.pattern % PATTERN_COUNT],
+               event.command,
+               (unsigned long)event.command_age_ms,
+               event.snapshot ? " | snapshot" : "");
+  }
+
+  if (detector.hasSnapshot())
+  {
+    // Next free name: earlier sessions' snapshots are kept
+    char path[24];
+    bool found = false;
+    while (storageReady && !found && glitchFiles < 1000)
+    {
+      snprintf(path, sizeof(path), "/glitch%03u.wav", glitchFiles++);
+      found = !SD.exists(path);
+    }
+
+    if (found)
+    {
+      if (detector.saveSnapshot(SD, path))
+      {
+        LOG_PRINTF("💾 Glitch snapshot: %s (%u frames, event in the middle)\n",
+                   path, GlitchDetector::SNAPSHOT_FRAMES);
+      }
+    }
+    else
+    {
+      detector.releaseSnapshot();
+    }
   }
 }
 
@@ -292,9 +575,11 @@ String formatMemory(uint32_t bytes)
 void loop()
 {
   static unsigned long lastMonitor = 0;
+  static int lastBpmRaw = -1;
 
-  // CHECK PATTERN SWITCHING (every 20 seconds)
-  if (millis() - lastPatternChange > PATTERN_CHANGE_INTERVAL)
+  // CHECK PATTERN SWITCHING (slower while evolving)
+  unsigned long changeInterval = evolveMode ? EVOLVE_CHANGE_INTERVAL : PATTERN_CHANGE_INTERVAL;
+  if (!songMode && millis() - lastPatternChange > changeInterval)
   {
     switchToNextPattern();
     lastPatternChange = millis();
@@ -302,9 +587,35 @@ void loop()
   if (millis() - lastPatternChange > 200)
   {
     uint16_t rawValue = muxController.get(0, 0);
-    uint16_t bpm = map(rawValue, 0, 1500, 16, 200);
-    bpm = constrain(bpm, 16, 200); // Sécurise les bornes
-    synthesizer.setBPM(bpm);
+
+    // A song keeps the BPM of its file until the pot is actually turned
+    bool moved = lastBpmRaw >= 0 && abs((int)rawValue - lastBpmRaw) > BPM_POT_DEADBAND;
+    if (lastBpmRaw < 0 || moved)
+    {
+      lastBpmRaw = rawValue;
+    }
+    if (!songMode || moved)
+    {
+      uint16_t bpm = map(rawValue, 0, 1500, 16, 200);
+      bpm = constrain(bpm, 16, 200); // Sécurise les bornes
+      synthesizer.setBPM(bpm);
+    }
+  }
+
+  reportGlitches();
+
+  // Serial commands: 'h' health table, 'r' start/stop recording
+  if (Serial.available())
+  {
+    char command = Serial.read();
+    if (command == 'h')
+    {
+      health.print();
+    }
+    else if (command == 'r')
+    {
+      toggleRecording();
+    }
   }
 
   // SYSTEM MONITORING (every 5 seconds)
@@ -312,51 +623,86 @@ void loop()
   {
     lastMonitor = millis();
 
-    // Memory calculations
-    uint32_t freeHeap = ESP.getFreeHeap();
-    uint32_t totalHeap = ESP.getHeapSize();
-    uint32_t usedHeap = totalHeap - freeHeap;
-    float usedPercent = (usedHeap * 100.0) / totalHeap;
+    LOG_PRINTF("=== ⚙️  FREE RTOS STATUS  ⚙️  ===\n");
 
-    Serial.printf("=== ⚙️  FREE RTOS STATUS  ⚙️  ===\n");
-    Serial.printf("💾 Memory: %s / %s (%.1f%% used)\n",
-                  formatMemory(usedHeap).c_str(),
-                  formatMemory(totalHeap).c_str(),
-                  usedPercent);
+    // Heap, watched task stacks, late audio blocks
+    health.printSummary();
 
-    // Task states
-    if (audioTaskHandle)
+    // Clock residency over the last 5 seconds
+    PowerManager::Residency residency = powerManager.readResidency();
+    LOG_PRINTF("⚡ CPU: %d MHz | 80: %.0f%% 160: %.0f%% 240: %.0f%% | peak load %.0f%% | %lu switches\n",
+               powerManager.getFrequencyMhz(),
+               residency.percent[0],
+               residency.percent[1],
+               residency.percent[2],
+               residency.peak_load * 100,
+               (unsigned long)residency.switches);
+
+    // Synthesizer status with current pattern
+    LOG_PRINTF("🎼 Pattern: %s | Step %d/%d | BPM %d | %s\n",
+               patternNames[currentPattern],
+               synthesizer.getCurrentStep() + 1,
+               synthesizer.getNumSteps(),
+               synthesizer.getBPM(),
+               synthesizer.isPlaying() ? "Playing" : "Stopped");
+
+    // Output levels over the last 5 seconds
+    MasterBus::Meter meter = synthesizer.getMasterBus().readMeter();
+    LOG_PRINTF("📊 Master: peak %+.1f dBFS | RMS %.1f dBFS | limited %lu | clipped %lu\n",
+               meter.peak_db,
+               meter.rms_db,
+               (unsigned long)meter.limited,
+               (unsigned long)meter.clipped);
+    GlitchDetector &detector = synthesizer.getGlitchDetector();
+    LOG_PRINTF("💥 Glitches: %lu clicks | %lu DC jumps | %lu clipped runs | %lu underruns\n",
+               (unsigned long)detector.getCount(GlitchDetector::DISCONTINUITY),
+               (unsigned long)detector.getCount(GlitchDetector::DC_JUMP),
+               (unsigned long)detector.getCount(GlitchDetector::CLIPPED_RUN),
+               (unsigned long)detector.getCount(GlitchDetector::UNDERRUN));
+    WavRecorder &recorder = synthesizer.getRecorder();
+    if (recorder.isRecording())
+    {
+      WavRecorder::Stats stats = recorder.readStats();
+      LOG_PRINTF("🎙️ Recording %s: %lu s | ring peak %d%% | %lu frames dropped | %lu write errors\n",
+                 recorder.getPath(),
+                 (unsigned long)(stats.frames_written / info.sample_rate),
+                 stats.max_fill,
+                 (unsigned long)stats.overrun_frames,
+                 (unsigned long)stats.write_errors);
+    }
+    LOG_PRINTF("🔇 Silent frames: %.0f%% (zero-filled)\n",
+               synthesizer.getRenderStream().readSilentPercent());
+    if (synthesizer.getRenderStream().isDualCore())
     {
-      Serial.printf("🎵 AudioTask: %s\n",
-                    eTaskGetState(audioTaskHandle) == eRunning ? "Running" : "Stopped");
+      LOG_PRINTF("🧵 Render worker: %lu slices rendered on Core 1 after a timeout\n",
+                 (unsigned long)synthesizer.getRenderStream().getWorkerFallbacks());
     }
-    if (muxTaskHandle)
+    LOG_PRINTF("📝 Log: %lu lines | %lu dropped | %lu rate-limited\n",
+               (unsigned long)asyncLog.getWritten(),
+               (unsigned long)asyncLog.getDropped(),
+               (unsigned long)asyncLog.getSuppressed());
+    if (telemetryMode)
     {
-      Serial.printf("🎛️  MuxTask: %s\n",
-                    eTaskGetState(muxTaskHandle) == eRunning ? "Running" : "Stopped");
+      LOG_PRINTF("📡 Telemetry: %lu frames | %lu dropped\n",
+                 (unsigned long)telemetry.getSent(),
+                 (unsigned long)telemetry.getDropped());
     }
 
-    // Synthesizer status with current pattern
-    Serial.printf("🎼 Pattern: %s | Step %d/%d | BPM %d | %s\n",
-                  patternNames[currentPattern],
-                  synthesizer.getCurrentStep() + 1,
-                  synthesizer.getNumSteps(),
-                  synthesizer.getBPM(),
-                  synthesizer.isPlaying() ? "Playing" : "Stopped");
-
-    // Time until next pattern change
-    unsigned long timeUntilChange = PATTERN_CHANGE_INTERVAL - (millis() - lastPatternChange);
-    Serial.printf("⏰ Next pattern in: %lu seconds\n", timeUntilChange / 1000);
-
-    Serial.println();
-  }
+    if (synthesizer.isEvolving())
+    {
+      PatternEngine &engine = synthesizer.getPatternEngine();
+      LOG_PRINTF("🧬 Evolution: %lu bars | %lu steps changed | %lu us worst\n",
+                 (unsigned long)engine.getBarsEvolved(),
+                 (unsigned long)engine.getStepsMutated(),
+                 (unsigned long)engine.getMaxGenerateUs());
+    }
+    if (!songMode)
+    {
+      // Time until next pattern change
+      unsigned long timeUntilChange = changeInterval - (millis() - lastPatternChange);
+      LOG_PRINTF("⏰ Next pattern in: %lu seconds\n", timeUntilChange / 1000);
+    }
 
-  /*
-  for (uint8_t i = 0; i < 16; ++i)
-  {
-    float raw = muxController.get(0, 0);
-    plotValues(0, (uint16_t)raw);
-    delay(5);
+    LOG_PRINTLN("");
   }
-*/
 }
\ No newline at end of file
@@ -0,0 +1,271 @@
+// Every kernel against the scalar formula that defines it, the fast paths
+// against their reference, bit for bit, on random blocks, then the time
+// the fast paths take.
+//   pio test -e native
+//   pio test -e esp32doit-devkit-v1
+#include <unity.h>
+#include <stdio.h>
+#include <DSPKernels.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+static uint32_t nowMicros() { return micros(); }
+#else
+#include <chrono>
+static uint32_t nowMicros()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+#endif
+
+static const uint32_t MAX_SAMPLES = 1024;
+static const uint16_t ROUNDS = 200;
+static const uint16_t BENCH_RUNS = 2000;
+
+static int16_t src16[MAX_SAMPLES];
+static int32_t src32[MAX_SAMPLES];
+static int16_t fast16[MAX_SAMPLES];
+static int16_t ref16[MAX_SAMPLES];
+static int32_t fast32[MAX_SAMPLES];
+static int32_t ref32[MAX_SAMPLES];
+
+// xorshift32: same blocks on every platform
+static uint32_t rng_state = 0x12345678;
+static uint32_t nextRandom()
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint32_t randomCount()
+{
+    // Odd sizes too: the unrolled loops have a tail
+    return nextRandom() % (MAX_SAMPLES + 1);
+}
+
+static void fillRandom()
+{
+    for (uint32_t i = 0; i < MAX_SAMPLES; i++)
+    {
+        src16[i] = (int16_t)nextRandom();
+        // Bus values: a few voices summed, sometimes past full scale
+        src32[i] = (int32_t)(nextRandom() % 262144) - 131072;
+        ref32[i] = (int32_t)(nextRandom() % 65536) - 32768;
+    }
+    memcpy(fast32, ref32, sizeof(fast32));
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_mix_accumulate()
+{
+    for (uint16_t r = 0; r < ROUNDS; r++)
+    {
+        fillRandom();
+        uint32_t count = randomCount();
+        DSPKernels::mixAccumulate(fast32, src16, count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            ref32[i] += src16[i];
+        }
+        TEST_ASSERT_EQUAL_INT32_ARRAY(ref32, fast32, MAX_SAMPLES);
+    }
+}
+
+static void test_accumulate()
+{
+    for (uint16_t r = 0; r < ROUNDS; r++)
+    {
+        fillRandom();
+        uint32_t count = randomCount();
+        DSPKernels::accumulate(fast32, src32, count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            ref32[i] += src32[i];
+        }
+        TEST_ASSERT_EQUAL_INT32_ARRAY(ref32, fast32, MAX_SAMPLES);
+    }
+}
+
+static void test_gain_ramp()
+{
+    for (uint16_t r = 0; r < ROUNDS; r++)
+    {
+        fillRandom();
+        uint8_t channels = 1 + r % 3; // mono, stereo and the generic path
+        uint32_t frames = randomCount() / channels;
+        int32_t start = nextRandom() % 32768;
+        int32_t end = r % 4 == 0 ? start : (int32_t)(nextRandom() % 32768); // constant gain too
+
+        memcpy(fast16, src16, sizeof(fast16));
+        memcpy(ref16, src16, sizeof(ref16));
+        DSPKernels::gainRamp(fast16, frames, channels, start, end);
+        DSPKernels::gainRampReference(ref16, frames, channels, start, end);
+        TEST_ASSERT_EQUAL_INT16_ARRAY(ref16, fast16, MAX_SAMPLES);
+    }
+}
+
+static int16_t clamp16(int64_t value)
+{
+    return (int16_t)(value > 32767 ? 32767 : value < -32768 ? -32768 : value);
+}
+
+static void test_saturate16()
+{
+    for (uint16_t r = 0; r < ROUNDS; r++)
+    {
+        fillRandom();
+        uint32_t count = randomCount();
+        memset(fast16, 0, sizeof(fast16));
+        memset(ref16, 0, sizeof(ref16));
+        DSPKernels::saturate16(src32, fast16, count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            ref16[i] = clamp16(src32[i]);
+        }
+        TEST_ASSERT_EQUAL_INT16_ARRAY(ref16, fast16, MAX_SAMPLES);
+    }
+}
+
+static void test_int16_to_q31()
+{
+    for (uint16_t r = 0; r < ROUNDS; r++)
+    {
+        fillRandom();
+        uint32_t count = randomCount();
+        memset(fast32, 0, sizeof(fast32));
+        memset(ref32, 0, sizeof(ref32));
+        DSPKernels::int16ToQ31(src16, fast32, count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            ref32[i] = (int32_t)((int64_t)src16[i] * 65536);
+        }
+        TEST_ASSERT_EQUAL_INT32_ARRAY(ref32, fast32, MAX_SAMPLES);
+    }
+}
+
+static void test_q31_to_int16()
+{
+    // Round half up, then saturate: full scale stays at 32767
+    const int32_t edges[] = {0, 0x7FFF, 0x8000, -0x8000, -0x8001, 0x7FFFFFFF, (int32_t)0x80000000, 0x7FFF8000, -0x7FFF8000};
+    const int16_t expected[] = {0, 0, 1, 0, -1, 32767, -32768, 32767, -32767};
+    const uint32_t num_edges = sizeof(edges) / sizeof(edges[0]);
+    int16_t edge_out[num_edges];
+    DSPKernels::q31ToInt16(edges, edge_out, num_edges);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(expected, edge_out, num_edges);
+
+    for (uint16_t r = 0; r < ROUNDS; r++)
+    {
+        fillRandom();
+        for (uint32_t i = 0; i < MAX_SAMPLES; i++)
+        {
+            src32[i] = (int32_t)nextRandom();
+        }
+        uint32_t count = randomCount();
+        memset(fast16, 0, sizeof(fast16));
+        memset(ref16, 0, sizeof(ref16));
+        DSPKernels::q31ToInt16(src32, fast16, count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            ref16[i] = clamp16(((int64_t)src32[i] + 32768) >> 16);
+        }
+        TEST_ASSERT_EQUAL_INT16_ARRAY(ref16, fast16, MAX_SAMPLES);
+    }
+}
+
+static void test_interleave()
+{
+    for (uint16_t r = 0; r < ROUNDS; r++)
+    {
+        fillRandom();
+        uint8_t channels = 1 + r % 3;
+        uint32_t frames = randomCount() / channels;
+        memset(fast16, 0, sizeof(fast16));
+        memset(ref16, 0, sizeof(ref16));
+        DSPKernels::interleave(src16, fast16, frames, channels);
+        DSPKernels::interleaveReference(src16, ref16, frames, channels);
+        TEST_ASSERT_EQUAL_INT16_ARRAY(ref16, fast16, MAX_SAMPLES);
+    }
+}
+
+// Time of BENCH_RUNS calls on a full block, fast path and reference. Reported,
+// not asserted: the ratio depends on the compiler and the target
+static void report(const char *name, uint32_t fast_us, uint32_t ref_us)
+{
+    char line[96];
+    snprintf(line, sizeof(line), "%-14s fast %6lu us | reference %6lu us | x%.2f",
+             name, (unsigned long)fast_us, (unsigned long)ref_us,
+             fast_us ? (float)ref_us / fast_us : 0.0f);
+    TEST_MESSAGE(line);
+}
+
+static void test_benchmark()
+{
+    fillRandom();
+    uint32_t start;
+    uint32_t fast_us;
+
+    start = nowMicros();
+    for (uint16_t i = 0; i < BENCH_RUNS; i++)
+    {
+        DSPKernels::gainRamp(fast16, MAX_SAMPLES / 2, 2, 32767, 16384);
+    }
+    fast_us = nowMicros() - start;
+    start = nowMicros();
+    for (uint16_t i = 0; i < BENCH_RUNS; i++)
+    {
+        DSPKernels::gainRampReference(ref16, MAX_SAMPLES / 2, 2, 32767, 16384);
+    }
+    report("gainRamp", fast_us, nowMicros() - start);
+
+    start = nowMicros();
+    for (uint16_t i = 0; i < BENCH_RUNS; i++)
+    {
+        DSPKernels::interleave(src16, fast16, MAX_SAMPLES / 2, 2);
+    }
+    fast_us = nowMicros() - start;
+    start = nowMicros();
+    for (uint16_t i = 0; i < BENCH_RUNS; i++)
+    {
+        DSPKernels::interleaveReference(src16, ref16, MAX_SAMPLES / 2, 2);
+    }
+    report("interleave", fast_us, nowMicros() - start);
+
+    // Keeps the loops from being optimised away
+    TEST_ASSERT_TRUE(fast16[0] != 0x7FFF || ref16[0] != 0x7FFF);
+}
+
+static int runTests()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_mix_accumulate);
+    RUN_TEST(test_accumulate);
+    RUN_TEST(test_gain_ramp);
+    RUN_TEST(test_saturate16);
+    RUN_TEST(test_int16_to_q31);
+    RUN_TEST(test_q31_to_int16);
+    RUN_TEST(test_interleave);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+    // Time for the test runner to open the serial port
+    delay(2000);
+    runTests();
+}
+
+void loop() {}
+#else
+int main()
+{
+    return runTests();
+}
+#endif
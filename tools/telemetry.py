@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""Host decoder for the synth's binary telemetry (lib/Telemetry).
+
+Reads the serial port, prints the log lines and decodes the frames in
+between. Records can be written to CSV files and/or plotted live.
+
+    pip install pyserial matplotlib
+    python tools/telemetry.py /dev/ttyUSB0
+    python tools/telemetry.py /dev/ttyUSB0 --csv run1 --plot
+
+Frame: 0x00, COBS([type][seq][timestamp_us u32 LE][payload][crc8]), 0x00
+"""
+
+import argparse
+import collections
+import csv
+import struct
+import sys
+import time
+
+import serial
+
+CONTROLS, VOICES, SYSTEM = 1, 2, 3
+NUM_CONTROLS = 32
+MAX_VOICES = 4
+STAGES = ["IDLE", "ATTACK", "DECAY", "SUSTAIN", "RELEASE"]
+PATTERNS = ["Tibetan Bowl", "Electronic", "Techno", "Acid House", "Generative"]
+
+
+def crc8(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data) + 1:
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def parse(frame):
+    """Returns (type, seq, time_s, fields) or None if it is not a frame."""
+    raw = cobs_decode(frame)
+    if raw is None or len(raw) < 7 or crc8(raw[:-1]) != raw[-1]:
+        return None
+    kind, seq, timestamp = struct.unpack_from("<BBI", raw)
+    payload = raw[6:-1]
+    t = timestamp / 1e6
+
+    if kind == CONTROLS and len(payload) == 2 * NUM_CONTROLS:
+        values = struct.unpack("<%dH" % NUM_CONTROLS, payload)
+        return kind, seq, t, {"pot%02d" % i: v for i, v in enumerate(values)}
+    if kind == VOICES and len(payload) == 1 + 3 * MAX_VOICES:
+        count = payload[0]
+        levels = struct.unpack_from("<%dH" % MAX_VOICES, payload, 1)
+        stages = payload[1 + 2 * MAX_VOICES:]
+        fields = {}
+        for v in range(count):
+            fields["level%d" % v] = levels[v] / 65535.0
+            fields["stage%d" % v] = STAGES[stages[v]] if stages[v] < len(STAGES) else stages[v]
+        return kind, seq, t, fields
+    if kind == SYSTEM and len(payload) == 12:
+        load, mhz, step, steps, bpm, pattern, playing = struct.unpack("<5HBB", payload)
+        return kind, seq, t, {
+            "dsp_load": load / 10.0,
+            "cpu_mhz": mhz,
+            "step": step,
+            "num_steps": steps,
+            "bpm": bpm,
+            "pattern": PATTERNS[pattern] if pattern < len(PATTERNS) else pattern,
+            "playing": playing,
+        }
+    return None
+
+
+class Recorder:
+    """One CSV file per record type: <prefix>_controls.csv, ..."""
+
+    NAMES = {CONTROLS: "controls", VOICES: "voices", SYSTEM: "system"}
+
+    def __init__(self, prefix):
+        self.prefix = prefix
+        self.files = {}
+
+    def write(self, kind, t, fields):
+        if kind not in self.files:
+            f = open("%s_%s.csv" % (self.prefix, self.NAMES[kind]), "w", newline="")
+            writer = csv.DictWriter(f, fieldnames=["time_s"] + list(fields))
+            writer.writeheader()
+            self.files[kind] = (f, writer)
+        f, writer = self.files[kind]
+        writer.writerow(dict(time_s="%.6f" % t, **fields))
+
+    def close(self):
+        for f, _ in self.files.values():
+            f.close()
+
+
+class Plotter:
+    """Scrolling plot of the DSP load, the envelopes and a few controls."""
+
+    def __init__(self, seconds, controls):
+        import matplotlib.pyplot as plt
+
+        self.plt = plt
+        self.seconds = seconds
+        self.controls = controls
+        self.series = collections.defaultdict(collections.deque)
+        plt.ion()
+        self.fig, self.axes = plt.subplots(3, 1, sharex=True, figsize=(10, 7))
+        self.last_draw = 0
+
+    def add(self, t, fields):
+        for name, value in fields.items():
+            if isinstance(value, (int, float)):
+                points = self.series[name]
+                points.append((t, value))
+                while points and points[0][0] < t - self.seconds:
+                    points.popleft()
+
+    def draw(self):
+        now = time.monotonic()
+        if now - self.last_draw < 0.1:
+            return
+        self.last_draw = now
+        groups = [
+            ("DSP load (%)", ["dsp_load"]),
+            ("Envelopes", [n for n in self.series if n.startswith("level")]),
+            ("Controls", ["pot%02d" % i for i in self.controls]),
+        ]
+        for ax, (title, names) in zip(self.axes, groups):
+            ax.clear()
+            ax.set_title(title, fontsize=9)
+            for name in names:
+                points = self.series.get(name)
+                if points:
+                    ax.plot([p[0] for p in points], [p[1] for p in points], label=name, linewidth=1)
+            if names:
+                ax.legend(loc="upper left", fontsize=7)
+        self.plt.pause(0.001)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--csv", metavar="PREFIX", help="record every frame to PREFIX_<type>.csv")
+    parser.add_argument("--plot", action="store_true", help="live plot (matplotlib)")
+    parser.add_argument("--window", type=float, default=10.0, help="plot window in seconds")
+    parser.add_argument("--controls", type=int, nargs="*", default=[0, 1, 2, 3], help="mux channels to plot")
+    parser.add_argument("--quiet", action="store_true", help="do not print the decoded frames")
+    args = parser.parse_args()
+
+    port = serial.Serial(args.port, args.baud, timeout=0.05)
+    recorder = Recorder(args.csv) if args.csv else None
+    plotter = Plotter(args.window, args.controls) if args.plot else None
+
+    buffer = bytearray()
+    last_seq = None  # one counter for all record types
+    frames = lost = 0
+
+    try:
+        while True:
+            buffer += port.read(4096)
+            while True:
+                end = buffer.find(b"\x00")
+                if end < 0:
+                    break
+                chunk = bytes(buffer[:end])
+                del buffer[:end + 1]
+                if not chunk:
+                    continue
+
+                record = parse(chunk)
+                if record is None:
+                    # Log text between two frames (printed when the next
+                    # frame starts: at 50 Hz that is never long)
+                    sys.stdout.write(chunk.decode("utf-8", errors="replace"))
+                    continue
+
+                kind, seq, t, fields = record
+                if last_seq is not None:
+                    lost += (seq - last_seq - 1) & 0xFF
+                last_seq = seq
+                frames += 1
+
+                if recorder:
+                    recorder.write(kind, t, fields)
+                if plotter:
+                    plotter.add(t, fields)
+                if not args.quiet and kind == SYSTEM:
+                    print("[%10.3f] load %5.1f%% | %d MHz | step %d/%d | %d BPM | %s | %d frames, %d lost"
+                          % (t, fields["dsp_load"], fields["cpu_mhz"], fields["step"] + 1, fields["num_steps"],
+                             fields["bpm"], fields["pattern"], frames, lost))
+
+            if plotter:
+                plotter.draw()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if recorder:
+            recorder.close()
+        port.close()
+
+
+if __name__ == "__main__":
+    main()